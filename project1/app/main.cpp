@@ -7,13 +7,13 @@
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
-#include <ctime>
 
 #include "../include/linked_list.hpp"
 #include "../include/hash_table.hpp"
 #include "../include/utils.hpp"
 #include "app_utils.hpp"
 #include "parse_utils.hpp"
+#include "record_file.hpp"
 
 #define HASHTABLE_BUCKETS 10000         // Number of buckets for the Citizen Hash Table
 #define MAX_BLOOM_SIZE 1000000          // Maximum Bloom Filter size allowed
@@ -223,45 +223,64 @@ int main(int argc, char const *argv[])
     bool vaccinated;
     Date date;
 
-    srand(time(NULL));
-
     // Starting input file processing
     printf("Processing input from file...\n");
-    // Read the file line by line
-    while( (line_buf = fgetline(input_file)) != NULL)
+    if (isRecordFile(input_file))
+    // Binary record file, so the records are inserted without any parsing
     {
-        buf_copy = new char[strlen(line_buf) + 1];
-        temp = new char[strlen(line_buf) + 3];
-        sprintf(temp, "~ %s", line_buf);            // just a "hack" so that the parsing function
-                                                    // can get all the line tokens using strtok.
-        strcpy(buf_copy, line_buf);
-        
-        strtok(temp, " ");       
-
-        // Parse the line
-        if (insertCitizenRecordParse(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date, NULL))
-        // If parsing was successful, try to insert the Record.
+        RecordFileReader reader(input_file);
+        unsigned int record_id;
+        unsigned short int record_age;
+        while (reader.readRecord(record_id, citizen_name, country_name, record_age, virus_name, vaccinated, date))
         {
-            insertVaccinationRecord(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date,
+            insertVaccinationRecord(record_id, citizen_name, country_name, record_age, virus_name, vaccinated, date,
                                     countries, viruses, citizens, bloom_size, NULL);
-            delete[] citizen_name;
-            delete[] country_name;
-            delete[] virus_name;
         }
-        else
-        // Parsing error
+        if (!reader.isValid())
         {
-            printf("ERROR in record: %s\n", buf_copy);
+            printf("ERROR: Invalid binary record file. Some records may have been skipped.\n");
+        }
+    }
+    else
+    // Text record file, so read the file line by line
+    {
+        while( (line_buf = fgetline(input_file)) != NULL)
+        {
+            buf_copy = new char[strlen(line_buf) + 1];
+            temp = new char[strlen(line_buf) + 3];
+            sprintf(temp, "~ %s", line_buf);            // just a "hack" so that the parsing function
+                                                        // can get all the line tokens using strtok.
+            strcpy(buf_copy, line_buf);
+        
+            strtok(temp, " ");       
+
+            // Parse the line
+            if (insertCitizenRecordParse(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date, NULL))
+            // If parsing was successful, try to insert the Record.
+            {
+                insertVaccinationRecord(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date,
+                                        countries, viruses, citizens, bloom_size, NULL);
+                delete[] citizen_name;
+                delete[] country_name;
+                delete[] virus_name;
+            }
+            else
+            // Parsing error
+            {
+                printf("ERROR in record: %s\n", buf_copy);
+            }
+            delete[] temp;
+            delete[] buf_copy;
+            free(line_buf);
         }
-        delete[] temp;
-        delete[] buf_copy;
-        free(line_buf);
     }
     // Done with file at this point.
     fclose(input_file);
 
     // Entering command line mode
     printf("Now in command line mode.\n");
+    // The banner marks the end of the startup phase (timed by bench/startup_bench.sh), so flush it right away
+    fflush(stdout);
     bool terminate = false;
     while( !terminate )
     {
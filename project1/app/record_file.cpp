@@ -0,0 +1,171 @@
+/**
+ * File: record_file.cpp
+ * Implementations of classes & routines used for reading Vaccination Records from binary record files.
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * The reader is a copy of the one in project3/app/record_file.cpp (without the writer). Every project is built
+ * on its own (the ADT's of lib/ are copied in each project as well), so any format change must be made in both.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "app_utils.hpp"
+#include "record_file.hpp"
+
+#define DAYS_PER_MONTH 30
+#define DAYS_PER_YEAR 360
+#define FIRST_YEAR 1990
+
+/* Little-endian field helpers ---------------------------------------------------------------------- */
+
+static unsigned int loadU16(const unsigned char *bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int loadU32(const unsigned char *bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+/**
+ * Stores the Date represented by the given packed Date (which must be non-zero) in date.
+ */
+static void unpackDate(unsigned int packed, Date &date)
+{
+    packed--;
+    date.set(packed % DAYS_PER_MONTH + 1, (packed / DAYS_PER_MONTH) % 12 + 1, packed / DAYS_PER_YEAR + FIRST_YEAR);
+}
+
+/**
+ * Checks whether the given file is a binary record file (begins with RECORD_FILE_MAGIC).
+ * The file position is restored to the beginning of the file.
+ */
+bool isRecordFile(FILE *file)
+{
+    char magic[RECORD_FILE_MAGIC_SIZE];
+    bool is_record_file = (fread(magic, sizeof(char), RECORD_FILE_MAGIC_SIZE, file) == RECORD_FILE_MAGIC_SIZE) &&
+                          (memcmp(magic, RECORD_FILE_MAGIC, RECORD_FILE_MAGIC_SIZE) == 0);
+    rewind(file);
+    return is_record_file;
+}
+
+/* RecordFileReader methods ------------------------------------------------------------------------- */
+
+/**
+ * Creates a Reader for the given binary record file (which must be at its beginning),
+ * and reads the file header (magic & dictionaries). If the header is invalid, isValid() returns FALSE.
+ */
+RecordFileReader::RecordFileReader(FILE *input):
+file(input), countries(NULL), viruses(NULL), num_countries(0), num_viruses(0), remaining_records(0), valid(false)
+{
+    char magic[RECORD_FILE_MAGIC_SIZE];
+    unsigned char count[4];
+    valid = (fread(magic, sizeof(char), RECORD_FILE_MAGIC_SIZE, file) == RECORD_FILE_MAGIC_SIZE) &&
+            (memcmp(magic, RECORD_FILE_MAGIC, RECORD_FILE_MAGIC_SIZE) == 0) &&
+            readDictionary(countries, num_countries) && readDictionary(viruses, num_viruses) &&
+            (fread(count, sizeof(unsigned char), 4, file) == 4);
+    if (valid)
+    {
+        remaining_records = loadU32(count);
+    }
+}
+
+RecordFileReader::~RecordFileReader()
+{
+    for (unsigned short int i = 0; i < num_countries; i++)
+    {
+        delete[] countries[i];
+    }
+    for (unsigned short int i = 0; i < num_viruses; i++)
+    {
+        delete[] viruses[i];
+    }
+    delete[] countries;
+    delete[] viruses;
+}
+
+/**
+ * Reads a dictionary (a number of strings) from the file.
+ * @returns TRUE if the whole dictionary was read successfully, FALSE otherwise.
+ */
+bool RecordFileReader::readDictionary(char **&dictionary, unsigned short int &size)
+{
+    unsigned char bytes[2];
+    if (fread(bytes, sizeof(unsigned char), 2, file) != 2)
+    {
+        return false;
+    }
+    unsigned short int entries = loadU16(bytes);
+    dictionary = new char*[entries];
+    // size is the number of entries that are actually stored (and will be deleted)
+    for (size = 0; size < entries; size++)
+    {
+        int len = fgetc(file);
+        if (len == EOF)
+        {
+            return false;
+        }
+        dictionary[size] = new char[len + 1];
+        if (fread(dictionary[size], sizeof(char), len, file) != (size_t)len)
+        {
+            delete[] dictionary[size];
+            return false;
+        }
+        dictionary[size][len] = '\0';
+    }
+    return true;
+}
+
+bool RecordFileReader::isValid() const
+{
+    return valid;
+}
+
+/**
+ * @brief Reads the next Vaccination Record of the file.
+ * The returned strings are owned by the Reader, and remain valid until the next record is read.
+ *
+ * @returns TRUE if a record was read successfully, FALSE if there are no more records or the record was invalid.
+ */
+bool RecordFileReader::readRecord(unsigned int &citizen_id, char *&full_name, char *&country_name,
+                                  unsigned short int &age, char *&virus_name, bool &vaccinated, Date &date)
+{
+    unsigned char fixed[RECORD_FILE_FIXED_SIZE];
+    if (!valid || remaining_records == 0 ||
+        fread(fixed, sizeof(unsigned char), RECORD_FILE_FIXED_SIZE, file) != RECORD_FILE_FIXED_SIZE)
+    {
+        return false;
+    }
+    remaining_records--;
+
+    unsigned int country_index = loadU16(fixed + 5);
+    unsigned int virus_index = loadU16(fixed + 7);
+    unsigned int packed_date = loadU16(fixed + 9);
+    unsigned int name_len = fixed[11];
+    if (country_index >= num_countries || virus_index >= num_viruses ||
+        fread(name_buffer, sizeof(char), name_len, file) != name_len)
+    // Invalid record, so stop reading the file
+    {
+        valid = false;
+        return false;
+    }
+    name_buffer[name_len] = '\0';
+
+    citizen_id = loadU32(fixed);
+    age = fixed[4];
+    country_name = countries[country_index];
+    virus_name = viruses[virus_index];
+    full_name = name_buffer;
+    vaccinated = (packed_date != 0);
+    if (vaccinated)
+    {
+        unpackDate(packed_date, date);
+    }
+    else
+    {
+        date.set(0, 0, 0);
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+/**
+ * File: record_file.hpp
+ * Classes & routines used for reading Vaccination Records from binary record files
+ * (created by the recordConverter tool of project 3).
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * Binary record file format (all numbers are little-endian):
+ *
+ *   RECORD_FILE_MAGIC
+ *   <number of countries (16-bit)> { <name length (8-bit)> <name bytes> }
+ *   <number of viruses (16-bit)>   { <name length (8-bit)> <name bytes> }
+ *   <number of records (32-bit)>
+ *   { <citizen id (32-bit)> <age (8-bit)> <country index (16-bit)> <virus index (16-bit)>
+ *     <packed date (16-bit)> <full name length (8-bit)> <full name bytes> }
+ *
+ * The packed date is 0 for a NO record, otherwise it is the number of days since 1-1-1990
+ * (with 30-day months) plus 1, for a YES record.
+ */
+
+#ifndef RECORD_FILE_HPP
+#define RECORD_FILE_HPP
+
+#include <cstdio>
+
+#define RECORD_FILE_MAGIC "VMRECBIN"        // The first bytes of every binary record file
+#define RECORD_FILE_MAGIC_SIZE 8
+#define RECORD_FILE_MAX_STRING 255          // Maximum length of names stored in binary record files
+#define RECORD_FILE_FIXED_SIZE 12           // Bytes of a record before the full name bytes
+
+class Date;
+
+bool isRecordFile(FILE *file);
+
+/**
+ * Used for reading Vaccination Records from a binary record file.
+ */
+class RecordFileReader
+{
+    private:
+        FILE *file;
+        char **countries;                           // The country dictionary
+        char **viruses;                             // The virus dictionary
+        unsigned short int num_countries;
+        unsigned short int num_viruses;
+        unsigned int remaining_records;             // Number of records not read yet
+        char name_buffer[RECORD_FILE_MAX_STRING + 1];
+        bool valid;                                 // FALSE if the header was invalid
+        bool readDictionary(char **&dictionary, unsigned short int &size);
+    public:
+        RecordFileReader(FILE *input);
+        ~RecordFileReader();
+        bool isValid() const;
+        bool readRecord(unsigned int &citizen_id, char *&full_name, char *&country_name, unsigned short int &age,
+                        char *&virus_name, bool &vaccinated, Date &date);
+};
+
+#endif
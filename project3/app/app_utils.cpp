@@ -9,18 +9,28 @@
 #include <cstdio>
 #include <ctime>
 #include <cstdlib>
+#include <cstdint>
 #include <cstdarg>
 #include <string>
 #include <sstream>
 
 #include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
 
 #include "app_utils.hpp"
+#ifdef USE_INOTIFY
+#include <sys/inotify.h>     // USE_INOTIFY is defined in app_utils.hpp
+#endif
 #include "../include/linked_list.hpp"
-#include "../include/rb_tree.hpp"
 #include "../include/skip_list.hpp"
 #include "../include/bloom_filter.hpp"
+#include "../include/scalable_bloom_filter.hpp"
+#include "../include/roaring_bitmap.hpp"
 #include "../include/hash_table.hpp"
+#include "../include/hash_functions.hpp"
+#include "../include/fenwick_tree.hpp"
 
 
 /**
@@ -51,6 +61,43 @@ char* copyString(const char *str)
     return copy;
 }
 
+/**
+ * Writes the specified string (preceded by its length) in the given file.
+ */
+void writeString(FILE *file, const char *string)
+{
+    uint16_t len = strlen(string);
+    fwrite(&len, sizeof(uint16_t), 1, file);
+    fwrite(string, sizeof(char), len, file);
+}
+
+/**
+ * Reads a string (preceded by its length) from the given file, and stores it in string,
+ * which is expanded if needed. string_size is the current size of string.
+ *
+ * @returns TRUE if the string was read successfully, FALSE otherwise.
+ */
+bool readString(FILE *file, char *&string, uint16_t &string_size)
+{
+    uint16_t len;
+    if (fread(&len, sizeof(uint16_t), 1, file) != 1)
+    {
+        return false;
+    }
+    if (len + 1 > string_size || string == NULL)
+    {
+        delete[] string;
+        string_size = len + 1;
+        string = new char[string_size];
+    }
+    if (fread(string, sizeof(char), len, file) != len)
+    {
+        return false;
+    }
+    string[len] = '\0';
+    return true;
+}
+
 /**
  * Date class functions ---------------------------------------------------------------------------
  */
@@ -80,9 +127,9 @@ void Date::set(unsigned short int d, unsigned short int m, unsigned short int y)
  */
 bool Date::isValidDate() const
 {
-    return ( (day >= 1) && (day <= 30) && 
+    return ( (day >= 1) && (day <= DAYS_PER_MONTH) && 
              (month >= 1) && (month <= 12) &&
-             (year >= 1990) && (year <= 2100));
+             (year >= MIN_YEAR) && (year <= MAX_YEAR));
 }
 
 bool Date::isNullDate() const
@@ -174,6 +221,83 @@ int compareDates(void *a, void *b)
     return 0;
 }
 
+/**
+ * DateCounter class functions --------------------------------------------------------------------
+ */
+
+DateCounter::DateCounter():
+years(new FenwickTree(MAX_YEAR - MIN_YEAR + 1)), days(new FenwickTree*[MAX_YEAR - MIN_YEAR + 1])
+{
+    for (unsigned int i = 0; i < years->getSize(); i++)
+    {
+        days[i] = NULL;
+    }
+}
+
+DateCounter::~DateCounter()
+{
+    for (unsigned int i = 0; i < years->getSize(); i++)
+    {
+        delete days[i];
+    }
+    delete[] days;
+    delete years;
+}
+
+/**
+ * Adds value (which may be negative) to the count of the specified (valid) Date.
+ */
+void DateCounter::add(const Date &date, int value)
+{
+    unsigned int year = date.year - MIN_YEAR;
+    if (days[year] == NULL)
+    // The first event of this year, so create its daily counts
+    {
+        days[year] = new FenwickTree(DAYS_PER_YEAR);
+    }
+    years->add(year, value);
+    days[year]->add((date.month - 1) * DAYS_PER_MONTH + date.day - 1, value);
+}
+
+/**
+ * Returns the number of events before the specified (valid) Date.
+ */
+unsigned int DateCounter::countBefore(const Date &date) const
+{
+    unsigned int year = date.year - MIN_YEAR;
+    unsigned int day = (date.month - 1) * DAYS_PER_MONTH + date.day - 1;
+    unsigned int count = (year > 0) ? years->prefixSum(year - 1) : 0;
+    if (days[year] != NULL && day > 0)
+    {
+        count += days[year]->prefixSum(day - 1);
+    }
+    return count;
+}
+
+/**
+ * Returns the number of events between the specified (valid) Dates (inclusive).
+ */
+unsigned int DateCounter::count(const Date &start, const Date &end) const
+{
+    if (compareDates(start, end) > 0)
+    {
+        return 0;
+    }
+    // The events up to end are the events before end, plus the events of end
+    unsigned int year = end.year - MIN_YEAR;
+    unsigned int day = (end.month - 1) * DAYS_PER_MONTH + end.day - 1;
+    unsigned int until_end = countBefore(end) + ((days[year] != NULL) ? days[year]->rangeSum(day, day) : 0);
+    return until_end - countBefore(start);
+}
+
+/**
+ * Returns the total number of events.
+ */
+unsigned int DateCounter::total() const
+{
+    return years->prefixSum(years->getSize() - 1);
+}
+
 /**
  * Citizen Record functions -----------------------------------------------------------------------
  */
@@ -332,27 +456,6 @@ int compareVaccinationRecordsByCitizen(void *a, void *b)
     return compareCitizens(citizen1, citizen2);
 }
 
-/**
- * Compares Vaccination Records a and b by comparing their Dates.
- * If the Dates are equal, the citizens they refer to will be compared.
- * 
- * @returns > 0 if Record A is "greater" (either by Date or by Citizen), 0 if they are equal, < 0 otherwise.
- */
-int compareVaccinationsDateFirst(void *a, void *b)
-{
-    VaccinationRecord *rec1 = static_cast<VaccinationRecord*>(a);
-    VaccinationRecord *rec2 = static_cast<VaccinationRecord*>(b);
-
-    int cmp = compareDates(&(rec1->date), &(rec2->date));
-
-    if (cmp != 0)
-    {
-        return cmp;
-    }
-
-    return compareCitizens(rec1->citizen, rec2->citizen);
-}
-
 /**
  * Compares the given ID with the citizen ID of the specified Vaccination Record.
  * @return 0 if the ID's are equal, a positive number if
@@ -378,16 +481,30 @@ void displayVaccinationCitizen(void *record)
  * Virus Records Methods-Functions ----------------------------------------------------------------
  */
 
+/**
+ * Creates the Bloom Filter of a Virus, which tracks its changes. If SCALABLE_BLOOM_FILTERS is defined,
+ * stages of up to max_stage_bytes are added as it fills up, otherwise it keeps its first stage only.
+ */
+static ScalableBloomFilter* newVirusFilter(unsigned long filter_bytes, unsigned int num_hashes, unsigned long max_stage_bytes)
+{
+    #ifdef SCALABLE_BLOOM_FILTERS
+    return new ScalableBloomFilter(filter_bytes, num_hashes, max_stage_bytes, true);
+    #else
+    return new ScalableBloomFilter(filter_bytes, num_hashes, 0, true);
+    #endif
+}
+
 /**
  * @brief Creates a Virus Records object with the specified information.
  * @param name The name of the Virus (a copy will be stored).
  * @param skip_list_layers The number of max layers for the Skip Lists.
- * @param filter_bits The number of bytes for the Bloom Filter.
+ * @param filter_bits The number of bytes for the Bloom Filter, which is also the maximum size of its stages.
+ * The Bloom Filter tracks its changes, so that only the changed words are sent after an update.
  */
 VirusRecords::VirusRecords(char *name, int skip_list_layers, unsigned long filter_bytes):
 vaccinated(new SkipList(skip_list_layers, delete_object<VaccinationRecord>)),
-non_vaccinated(new SkipList(skip_list_layers, delete_object<VaccinationRecord>)),
-filter(new BloomFilter(filter_bytes)), virus_name(copyString(name)) { }
+non_vaccinated(new SkipList(skip_list_layers, delete_object<VaccinationRecord>)), max_filter_bytes(filter_bytes),
+filter(newVirusFilter(filter_bytes, K_MAX, filter_bytes)), vaccinated_ids(new RoaringBitmap()), virus_name(copyString(name)) { }
 
 VirusRecords::~VirusRecords()
 {
@@ -395,6 +512,7 @@ VirusRecords::~VirusRecords()
     delete vaccinated;
     delete [] virus_name;
     delete filter;
+    delete vaccinated_ids;
 }
 
 /**
@@ -428,6 +546,22 @@ VaccinationRecord* VirusRecords::getVaccinationRecord(int citizenID) const
     return static_cast<VaccinationRecord*>(this->vaccinated->find(&citizenID, compareIdToVaccinationRecord));
 }
 
+/**
+ * Returns the Skip List with the Vaccination Records of vaccinated persons.
+ */
+const SkipList* VirusRecords::getVaccinatedList() const
+{
+    return this->vaccinated;
+}
+
+/**
+ * Returns the Skip List with the Vaccination Records of non-vaccinated persons.
+ */
+const SkipList* VirusRecords::getNonVaccinatedList() const
+{
+    return this->non_vaccinated;
+}
+
 /**
  * Returns TRUE if the given citizen ID is "possibly present"
  * according to the Bloom Filter, FALSE otherwise.
@@ -437,6 +571,61 @@ bool VirusRecords::checkBloomFilter(char *citizen_id) const
     return this->filter->isPresent(citizen_id);
 }
 
+/**
+ * Replaces the Bloom Filter with a new one, with the specified size (in bytes) and number of Hash Functions
+ * for its first stage, where the IDs of all the vaccinated persons are marked as present.
+ * If the filter is merged with the filters of other Monitors, shared_items is the (estimated) number of items
+ * in the merged filter, so that new stages are added when the merged filter (and not just this one) is full.
+ */
+void VirusRecords::rebuildFilter(unsigned long filter_bytes, unsigned int num_hashes, unsigned long shared_items)
+{
+    char char_id[MAX_ID_DIGITS + 1]; // max digits + \0
+    ScalableBloomFilter *new_filter = newVirusFilter(filter_bytes, num_hashes, this->max_filter_bytes);
+    unsigned long num_vaccinated = 0;
+    for (SkipList::SkipListIterator itr = this->vaccinated->listHead(); !itr.isNull(); itr.forward())
+    {
+        sprintf(char_id, "%d", static_cast<VaccinationRecord*>(itr.getData())->citizen->id);
+        new_filter->markAsPresent(char_id);
+        num_vaccinated++;
+    }
+    if (shared_items > num_vaccinated && new_filter->getNumStages() == 1)
+    {
+        new_filter->countItems(shared_items - num_vaccinated);
+    }
+    delete this->filter;
+    this->filter = new_filter;
+}
+
+/**
+ * Rebuilds the Bloom Filter with the size & number of Hash Functions selected by BloomFilter::chooseParameters
+ * for the current number of vaccinated persons (the size will not exceed max_bytes).
+ * The Bloom Filter is not rebuilt if it already has the selected parameters (and a single stage).
+ */
+void VirusRecords::resizeFilter(unsigned long max_bytes)
+{
+    unsigned long filter_bytes;
+    unsigned int num_hashes;
+    BloomFilter::chooseParameters(countVaccinated(), max_bytes, filter_bytes, num_hashes);
+    BloomFilter *first_stage = this->filter->getStage(0);
+    if (this->filter->getNumStages() != 1 || filter_bytes != first_stage->numBytes || num_hashes != first_stage->numHashes)
+    {
+        rebuildFilter(filter_bytes, num_hashes);
+    }
+}
+
+/**
+ * Returns the number of vaccinated persons.
+ */
+unsigned long VirusRecords::countVaccinated() const
+{
+    unsigned long num_vaccinated = 0;
+    for (SkipList::SkipListIterator itr = this->vaccinated->listHead(); !itr.isNull(); itr.forward())
+    {
+        num_vaccinated++;
+    }
+    return num_vaccinated;
+}
+
 /**
  * @brief Attempts to insert the specified Vaccination Record in the Skip List & Bloom Filter.
  * 
@@ -470,6 +659,7 @@ bool VirusRecords::insertRecordOrShowExisted(VaccinationRecord *record, Vaccinat
             // Inserting in bloom filter as well
             sprintf(char_id, "%d", (*present)->citizen->id);
             this->filter->markAsPresent(char_id);
+            this->vaccinated_ids->add((*present)->citizen->id);
 
             // displayMessage(fstream, "SUCCESSFULLY VACCINATED\n");
             // Indicate that the existing record was previously marked
@@ -486,6 +676,7 @@ bool VirusRecords::insertRecordOrShowExisted(VaccinationRecord *record, Vaccinat
             // Inserting in bloom filter as well
             sprintf(char_id, "%d", record->citizen->id);
             this->filter->markAsPresent(char_id);
+            this->vaccinated_ids->add(record->citizen->id);
 
             // displayMessage(fstream, "SUCCESSFULLY VACCINATED\n");
             return true;
@@ -539,30 +730,61 @@ int compareNameVirusRecord(void *name, void *virus_record)
  * Virus Country Status functions -----------------------------------------------------------------
  */
 
+/**
+ * Returns the index of the age group of the given age: [0-19], [20-39], [40-59] or 60+.
+ */
+static unsigned int ageGroup(int age)
+{
+    if (age < 20)
+    {
+        return 0;
+    }
+    else if (age < 40)
+    {
+        return 1;
+    }
+    else if (age < 60)
+    {
+        return 2;
+    }
+    return 3;
+}
+
 /**
  * @brief Creates a Virus information structure for a specific Country.
  * @param name The name of the Virus. Note than this is the *exact same* character array address
  * stored in VirusRecords for this Virus.
- * @param tree_func The comparison function to use in the Vaccinations Tree.
  */
-VirusCountryStatus::VirusCountryStatus(char *name, CompareFunc tree_func):
-record_tree(new RedBlackTree(tree_func)),
+VirusCountryStatus::VirusCountryStatus(char *name):
 total_population(0), population_bellow_20(0), population_20_40(0), population_40_60(0), population_60_plus(0),
-virus_name(name) { }
+virus_name(name)
+{
+    for (unsigned int i = 0; i < AGE_GROUPS; i++)
+    {
+        vaccinations[i] = new DateCounter();
+    }
+}
 
 VirusCountryStatus::~VirusCountryStatus()
 {
-    delete record_tree;                     
+    for (unsigned int i = 0; i < AGE_GROUPS; i++)
+    {
+        delete vaccinations[i];
+    }
     // Note that virus_name is NOT deleted. 
     // It will be deleted when VirusRecords destructor is called.
 }
 
 /**
- * Stores the specified Record in the Vaccinations Tree.
+ * Counts the specified ("YES") Record in the vaccinations of its Date, for the age group of its Citizen.
+ * The Record itself is not stored.
  */
 void VirusCountryStatus::storeVaccinationRecord(VaccinationRecord *record)
 {
-    this->record_tree->insert(record);
+    if (record->date.isValidDate())
+    {
+        this->vaccinations[ageGroup(record->citizen->age)]->add(record->date, 1);
+    }
 }
 
 /**
@@ -593,94 +815,14 @@ void VirusCountryStatus::updatePopulation(CitizenRecord *citizen)
 }
 
 /**
- * While traversing the subtree starting with root recursively, 
- * counts the number of vaccinated persons between the two Dates
- * and updates the population counter.
+ * Adds the number of vaccinated persons between the two Dates in the counter.
  */
-void VirusCountryStatus::getTotalStatsRec(int &total, Date start, Date end, RBTreeNode *root) const
-{
-    if (root == NULL) { return; }
-    // Getting the root Record
-    VaccinationRecord *root_data = static_cast<VaccinationRecord*>(root->data);
-
-    if (compareDates(&root_data->date, &start) >= 0)
-    // root Date is greater than start
-    {
-        // so count stats in Left subtree
-        getTotalStatsRec(total, start, end, root->left);
-        if (compareDates(&root_data->date, &end) <= 0)
-        // end is greater than root Date
-        {
-            // root is in range, so update the counter
-            total++;
-            // and count stats in the right subtree
-            getTotalStatsRec(total, start, end, root->right);
-            return;
-        }
-    }
-    // root is smaller than start, so just search to the right
-    if (compareDates(&root_data->date, &end) <= 0)
-    {
-        getTotalStatsRec(total, start, end, root->right);
-    }
-}
-
-/**
- * While traversing the subtree starting with root recursively, 
- * counts the number of vaccinated persons between the two Dates for each age group
- * and updates the age group counters.
- */
-void VirusCountryStatus::getAgeStatsRec(int &bellow_20, int &between20_40, int &between40_60,
-                                        int &plus60, Date start, Date end, RBTreeNode *root) const
+void VirusCountryStatus::getTotalVaccinationStats(int &total, Date start, Date end) const
 {
-    if (root == NULL) { return; }
-    // Getting the root Record
-    VaccinationRecord *root_data = static_cast<VaccinationRecord*>(root->data);
-
-    if (compareDates(&root_data->date, &start) >= 0)
-    // root Date is greater than start
+    for (unsigned int i = 0; i < AGE_GROUPS; i++)
     {
-        // so count stats in Left subtree
-        getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, start, end, root->left);
-        if (compareDates(&root_data->date, &end) <= 0)
-        // end is greater than root Date
-        {
-            // root Date is between the limits, so update the correct counter
-            updateAgeCounter(root_data->citizen->age, bellow_20, between20_40, between40_60, plus60);
-            // and count stats in the right subtree
-            getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, start, end, root->right);
-            return;
-        }
+        total += this->vaccinations[i]->count(start, end);
     }
-    // root is smaller than start, so just search to the right
-    getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, start, end, root->right);
-}
-
-/**
- * While traversing the subtree starting with root recursively, 
- * counts the number of vaccinated persons for each age group
- * and updates the age group counters.
- */
-void VirusCountryStatus::getAgeStatsRec(int &bellow_20, int &between20_40, int &between40_60,
-                                        int &plus60, RBTreeNode *root) const
-{
-    if (root == NULL) { return; }
-    // Getting the root Record
-    VaccinationRecord *root_data = static_cast<VaccinationRecord*>(root->data);
-
-    // Update the correct counter
-    updateAgeCounter(root_data->citizen->age, bellow_20, between20_40, between40_60, plus60);
-    // And count stats from left and right subtree
-    getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, root->left);
-    getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, root->right);
-}
-
-/**
- * Stores the number of vaccinated persons between the two Dates in the counter.
- */
-void VirusCountryStatus::getTotalVaccinationStats(int &total, Date start, Date end) const
-{
-    this->getTotalStatsRec(total, start, end, this->record_tree->root);
 }
 
 /**
@@ -688,54 +830,35 @@ void VirusCountryStatus::getTotalVaccinationStats(int &total, Date start, Date e
  */
 void VirusCountryStatus::getTotalVaccinationStats(int &total) const
 {
-    total = this->record_tree->getNumElements();
+    total = 0;
+    for (unsigned int i = 0; i < AGE_GROUPS; i++)
+    {
+        total += this->vaccinations[i]->total();
+    }
 }
 
 /**
- * Stores the number of vaccinated persons between the two Dates for each age group in the proper counter.
+ * Adds the number of vaccinated persons between the two Dates for each age group in the proper counter.
  */
 void VirusCountryStatus::getVaccinationStatsByAge( int &bellow_20, int &between20_40, int &between40_60,
                                                    int &plus60, Date start, Date end) const
 {
-    this->getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, start, end, this->record_tree->root);
+    bellow_20 += this->vaccinations[0]->count(start, end);
+    between20_40 += this->vaccinations[1]->count(start, end);
+    between40_60 += this->vaccinations[2]->count(start, end);
+    plus60 += this->vaccinations[3]->count(start, end);
 }
 
 /**
- * Stores the number of vaccinated persons for each age group in the proper counter.
+ * Adds the number of vaccinated persons for each age group in the proper counter.
  */
 void VirusCountryStatus::getVaccinationStatsByAge( int &bellow_20, int &between20_40, int &between40_60,
                                                    int &plus60 ) const
 {
-    this->getAgeStatsRec(bellow_20, between20_40, between40_60, plus60, this->record_tree->root);
-}
-
-/**
- * Updates the correct age counter according to the given age.
- * @param age The given Age.
- * @param bellow_20 The counter for age group [0-19]
- * @param between20_40 The counter for age group [20-39]
- * @param between40_60 The counter for age group [40-59]
- * @param plus60 The counter for age group 60+
- */
-void VirusCountryStatus::updateAgeCounter(int age, int &bellow_20, int &between20_40, 
-                                          int &between40_60, int &plus60) const
-{
-    if (age < 20)
-    {
-        bellow_20++;
-    }
-    else if (age < 40)
-    {
-        between20_40++;
-    }
-    else if (age < 60)
-    {
-        between40_60++;
-    }
-    else
-    {
-        plus60++;
-    }
+    bellow_20 += this->vaccinations[0]->total();
+    between20_40 += this->vaccinations[1]->total();
+    between40_60 += this->vaccinations[2]->total();
+    plus60 += this->vaccinations[3]->total();
 }
 
 /**
@@ -772,7 +895,7 @@ void CountryStatus::storeCitizenVaccinationRecord(VaccinationRecord *record)
     // Did not find information about this Virus
     {
         // So create it now
-        this->virus_status->append(new VirusCountryStatus(record->virus_name, compareVaccinationsDateFirst));
+        this->virus_status->append(new VirusCountryStatus(record->virus_name));
         virus_tree = static_cast<VirusCountryStatus*>(this->virus_status->getLast());
     }
     // Store the Record in the Virus structure.
@@ -795,7 +918,7 @@ void CountryStatus::storeNewVaccinationRecord(VaccinationRecord *record)
     // Did not find information about this Virus
     {
         // So create it now
-        this->virus_status->append(new VirusCountryStatus(record->virus_name, compareVaccinationsDateFirst));
+        this->virus_status->append(new VirusCountryStatus(record->virus_name));
         virus_tree = static_cast<VirusCountryStatus*>(this->virus_status->getLast());
     }
     // Store the Record in the Virus structure.
@@ -807,6 +930,15 @@ void CountryStatus::storeNewVaccinationRecord(VaccinationRecord *record)
     virus_tree->updatePopulation(record->citizen);
 }
 
+/**
+ * Returns the information of this Country about the specified Virus,
+ * or NULL if no Record of a citizen of this Country refers to this Virus.
+ */
+const VirusCountryStatus* CountryStatus::getVirusStatus(const char *virus_name) const
+{
+    return static_cast<VirusCountryStatus*>(this->virus_status->getElement((void*)virus_name, compareNameVirusCountryStatus));
+}
+
 /**
  * Compares the given virus name to the virus name of the
  * specified VirusCountryStatus.
@@ -841,8 +973,10 @@ int compareNameCountryStatus(void *name, void *country_status)
  * @param citizens A HashTable with all the stored Citizens.
  * @param bloom_bytes The number of bytes in Bloom Filters.
  * @param fstream The file stream to print output messages. If output is not desirable, NULL can be passed.
+ * @returns TRUE if the record was stored (or it marked an existing "non vaccinated" record as vaccinated),
+ * FALSE if it was rejected.
  */
-void insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *country_name, unsigned short int age,
+bool insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *country_name, unsigned short int age,
                              char *virus_name, bool vaccinated, Date &date,
                              LinkedList *countries, LinkedList *viruses, HashTable *citizens,
                              unsigned long bloom_bytes, FILE *fstream)
@@ -861,7 +995,7 @@ void insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *cou
         {
             displayMessage(fstream, "ERROR: A citizen with the same ID, but different info already exists:\n");
             displayCitizen(present);
-            return;
+            return false;
         }
         // The provided info is valid, so the existed citizen record will be used
         target_citizen = present;
@@ -908,6 +1042,7 @@ void insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *cou
     {
         // Store in Country structure as well
         new_record->citizen->country->storeNewVaccinationRecord(new_record);
+        return true;
     }
     else
     // The record was not inserted (was already present)
@@ -919,7 +1054,8 @@ void insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *cou
         {
             existing->citizen->country->storeCitizenVaccinationRecord(existing);
         }
-    }    
+        return status_changed;
+    }
 }
 
 /**
@@ -973,33 +1109,141 @@ void vaccineStatusBloom(int citizen_id, LinkedList *viruses, char *virus_name)
     }
 }
 
+/* File Info functions ------------------------------------------------------------------------- */
+
+FileInfo::FileInfo(const char *file_name):
+name(copyString(file_name)), size(-1), mtime(0), offset(0), notified(false) { }
+
+FileInfo::~FileInfo()
+{
+    delete[] name;
+}
+
+/**
+ * Compares the specified file name with the name of the specified FileInfo.
+ */
+int compareNameFileInfo(void *name, void *file_info)
+{
+    return strcmp((char*)name, static_cast<FileInfo*>(file_info)->name);
+}
+
+/**
+ * Returns the integer to get the hashcode of, for the specified file name.
+ */
+int fileNameHashObject(const char *name)
+{
+    return djb2((unsigned char*)name);
+}
+
+int fileInfoHashObject(void *file_info)
+{
+    return fileNameHashObject(static_cast<FileInfo*>(file_info)->name);
+}
+
 /* Directory Info functions -------------------------------------------------------------------- */
 
 DirectoryInfo::DirectoryInfo(const char *path_str):
-numContents(0), path(copyString(path_str)), contents(new LinkedList(delete_object_array<char>)) { }
+index(new HashTable(FILE_INDEX_BUCKETS, NULL, fileInfoHashObject)), notified_files(new LinkedList(NULL)),
+rescan_needed(false), path(copyString(path_str)), contents(new LinkedList(delete_object<FileInfo>)),
+watch_descriptor(-1) { }
 
 DirectoryInfo::~DirectoryInfo()
 {
     delete[] path;
+    // The index & the notified files list do not own the FileInfo objects
+    delete index;
+    delete notified_files;
     delete contents;
 }
 
+/**
+ * Returns the FileInfo of the file with the specified name, or NULL if it is not in the contents.
+ */
+FileInfo* DirectoryInfo::getFile(const char *name) const
+{
+    return static_cast<FileInfo*>(index->getElement(fileNameHashObject(name), (void*)name, compareNameFileInfo));
+}
+
+/**
+ * Adds a file with the specified name in the contents, and returns its FileInfo.
+ */
+FileInfo* DirectoryInfo::addFile(const char *name)
+{
+    FileInfo *file = new FileInfo(name);
+    contents->append(file);
+    index->insert(file);
+    return file;
+}
+
+/**
+ * Checks whether the specified file has changed (size or modification time) since it was last checked,
+ * and stores its current size and modification time.
+ *
+ * @returns TRUE if the file has changed (or was never checked), FALSE otherwise.
+ */
+bool DirectoryInfo::checkFile(FileInfo *file) const
+{
+    struct stat file_stat;
+    std::string file_path(path);
+    file_path.append("/").append(file->name);
+    if (stat(file_path.c_str(), &file_stat) == -1)
+    {
+        return false;
+    }
+    if (file_stat.st_size == file->size && file_stat.st_mtime == file->mtime)
+    {
+        return false;
+    }
+    file->size = file_stat.st_size;
+    file->mtime = file_stat.st_mtime;
+    return true;
+}
+
+/**
+ * Adds a file that has been reported by the watcher (i.e. it was created, moved, modified or written)
+ * in the contents (if it is not present), so that it is checked on the next update.
+ * A file is only stored once in the notified files, no matter how many events are reported for it.
+ */
+void DirectoryInfo::notifyFile(const char *name)
+{
+    FileInfo *file = getFile(name);
+    if (file == NULL)
+    // The file is not present, so add it in the content list
+    {
+        file = addFile(name);
+    }
+    if (!file->notified)
+    {
+        file->notified = true;
+        notified_files->append(file);
+    }
+}
+
+/**
+ * Makes the next update rescan the directory (e.g. when watch events have been lost).
+ */
+void DirectoryInfo::requestRescan()
+{
+    rescan_needed = true;
+}
+
 /**
  * Scans the directory associated with this DirectoryInfo, and
  * adds all found files in the contents list.
  */
-void DirectoryInfo::addContents()
+void DirectoryInfo::addContents(DirectoryWatcher *watcher)
 {
     int num_contents;
     struct dirent **dir_contents;
 
+    // Start watching before scanning, so that no file created in the meantime is missed
+    watcher->addDirectory(this);
     // Scan the directory
     num_contents = scandir(this->path, &dir_contents, NULL, alphasort);
     if (num_contents == -1)
     {
         return;
     }
-    this->numContents = num_contents;
     // Add each file to the contents list
     for (int i = 0; i < num_contents; i++)
     {
@@ -1010,7 +1254,8 @@ void DirectoryInfo::addContents()
         }
         else
         {
-            this->contents->append(copyString(dir_contents[i]->d_name));
+            // Store the current size & modification time as well
+            checkFile(addFile(dir_contents[i]->d_name));
         }
     }
     
@@ -1023,24 +1268,51 @@ void DirectoryInfo::addContents()
 }
 
 /**
- * Scans the directory associated with this DirectoryInfo, and
- * adds any newly found files in the contents list.
+ * Adds any newly created files of the directory associated with this DirectoryInfo in the contents list.
+ * New files, as well as files that have changed (e.g. records have been appended) since they were last checked,
+ * are appended in changed_files. If the directory is watched, only the files reported by the watcher
+ * (see DirectoryWatcher::readEvents) are checked. Otherwise, the directory is rescanned.
+ */
+void DirectoryInfo::updateContents(LinkedList *changed_files)
+{
+    if (watch_descriptor == -1 || rescan_needed)
+    {
+        for (LinkedList::ListIterator itr = notified_files->listHead(); !itr.isNull(); itr.forward())
+        {
+            static_cast<FileInfo*>(itr.getData())->notified = false;
+        }
+        rescanContents(changed_files);
+        rescan_needed = false;
+    }
+    else
+    {
+        for (LinkedList::ListIterator itr = notified_files->listHead(); !itr.isNull(); itr.forward())
+        {
+            FileInfo *file = static_cast<FileInfo*>(itr.getData());
+            file->notified = false;
+            if (checkFile(file))
+            {
+                changed_files->append(file);
+            }
+        }
+    }
+    delete notified_files;
+    notified_files = new LinkedList(NULL);
+}
+
+/**
+ * Scans the directory associated with this DirectoryInfo, adds any newly found files in the contents list,
+ * and appends the new or changed files in changed_files.
  */
-void DirectoryInfo::updateContents()
+void DirectoryInfo::rescanContents(LinkedList *changed_files)
 {
     int num_contents;
     struct dirent **dir_contents;
 
     // Scan the directory
     num_contents = scandir(this->path, &dir_contents, NULL, alphasort);
-    if (num_contents == -1 || this->numContents == num_contents)
-    // No new files found, so return
+    if (num_contents == -1)
     {
-        for (unsigned int i = 0; i < num_contents; i++)
-        {
-            free(dir_contents[i]);
-        }
-        free(dir_contents);
         return;
     }
     // Iterate over all the returned files
@@ -1051,16 +1323,16 @@ void DirectoryInfo::updateContents()
         {
             continue;
         }
-        else
+        FileInfo *file = getFile(dir_contents[i]->d_name);
+        if (file == NULL)
+        // The file is not present, so add it in the content list
         {
-            // If the file is already present, continue
-            if (this->contents->getElement(dir_contents[i]->d_name, compareStrings) != NULL)
-            {
-                continue;
-            }
-            // The file is not present, so add it in the content list
-            this->contents->append(copyString(dir_contents[i]->d_name));
-            this->numContents++;
+            file = addFile(dir_contents[i]->d_name);
+        }
+        if (checkFile(file))
+        // New or changed file
+        {
+            changed_files->append(file);
         }
     }
 
@@ -1072,6 +1344,125 @@ void DirectoryInfo::updateContents()
     free(dir_contents);
 }
 
+/* Directory Watcher functions ----------------------------------------------------------------- */
+
+/**
+ * Compares the given watch descriptor with the watch descriptor of the given DirectoryInfo.
+ */
+int compareWatchDirectory(void *watch_descriptor, void *dir)
+{
+    return *static_cast<int*>(watch_descriptor) - static_cast<DirectoryInfo*>(dir)->watch_descriptor;
+}
+
+/**
+ * Returns the integer to get the hashcode of, for the specified (watched) DirectoryInfo.
+ */
+int directoryWatchHashObject(void *dir)
+{
+    return static_cast<DirectoryInfo*>(dir)->watch_descriptor;
+}
+
+/**
+ * Creates the inotify instance of the watcher (if inotify is used).
+ * If it cannot be created, no directory is watched, so every directory is rescanned on every update.
+ */
+DirectoryWatcher::DirectoryWatcher():
+watch_fd(-1), watched(new HashTable(WATCH_INDEX_BUCKETS, NULL, directoryWatchHashObject)),
+directories(new LinkedList(NULL))
+{
+    #ifdef USE_INOTIFY
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    #endif
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    if (watch_fd != -1)
+    {
+        close(watch_fd);
+    }
+    // The index & the list do not own the DirectoryInfo objects
+    delete watched;
+    delete directories;
+}
+
+/**
+ * Starts watching the given directory for files that are created/moved/written in it, or appended to
+ * (IN_MODIFY is needed for writers that keep the file open). If the watch cannot be created, the directory will be rescanned on every update.
+ */
+void DirectoryWatcher::addDirectory(DirectoryInfo *dir)
+{
+    #ifdef USE_INOTIFY
+    if (watch_fd == -1)
+    {
+        return;
+    }
+    dir->watch_descriptor = inotify_add_watch(watch_fd, dir->path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY);
+    if (dir->watch_descriptor != -1)
+    {
+        watched->insert(dir);
+        directories->append(dir);
+    }
+    #endif
+}
+
+/**
+ * Reads all the pending watch events, and reports each created/moved/modified/written file to its directory
+ * (see DirectoryInfo::notifyFile). If any events have been lost, every watched directory will be rescanned.
+ * A directory whose watch has been removed (e.g. the directory was deleted) will be rescanned from now on.
+ */
+void DirectoryWatcher::readEvents()
+{
+    #ifdef USE_INOTIFY
+    if (watch_fd == -1)
+    {
+        return;
+    }
+    char events[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    bool events_lost = false;
+    while ( (len = read(watch_fd, events, sizeof(events))) > 0 )
+    {
+        const struct inotify_event *event;
+        for (char *ptr = events; ptr < events + len; ptr += sizeof(struct inotify_event) + event->len)
+        {
+            event = (const struct inotify_event*) ptr;
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                events_lost = true;
+                continue;
+            }
+            int wd = event->wd;
+            DirectoryInfo *dir = static_cast<DirectoryInfo*>(watched->getElement(wd, &wd, compareWatchDirectory));
+            if (dir == NULL)
+            {
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            // The watch has been removed, so the directory can only be rescanned
+            {
+                dir->requestRescan();
+                dir->watch_descriptor = -1;
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR))
+            // Not a file
+            {
+                continue;
+            }
+            dir->notifyFile(event->name);
+        }
+    }
+    if (events_lost || (len == -1 && errno != EAGAIN))
+    {
+        for (LinkedList::ListIterator itr = directories->listHead(); !itr.isNull(); itr.forward())
+        {
+            static_cast<DirectoryInfo*>(itr.getData())->requestRescan();
+        }
+    }
+    #endif
+}
+
 /**
  * An strcmp wrapper with void* arguments in order to be used by ADT's.
  */
@@ -8,18 +8,36 @@
 #ifndef APP_CLASSES_HPP
 #define APP_CLASSES_HPP
 
+#include <cstdio>
+#include <cstdint>
 #include <string>
+#include <sys/types.h>
 #include "../include/utils.hpp"
 
 #define CHILD_EXEC_NAME "monitorServer"
 #define CHILD_EXEC_PATH "./monitorServer"
 
 //#define SHOW_CYCLIC_BUFFER_MSG          // Comment out this to disable messages regarding cyclic buffer.
+#ifdef __linux__
+#define USE_INOTIFY                     // Comment out this to detect new directory files by rescanning the directories.
+#endif
+//#define USE_MSG_ZEROCOPY                // Define this to send large Bloom Filters using MSG_ZEROCOPY (Linux only).
+#define ZEROCOPY_MIN_BYTES 65536        // Minimum Bloom Filter payload size to be sent using MSG_ZEROCOPY
+#define SCALABLE_BLOOM_FILTERS          // Comment out this to keep the Monitor Bloom Filters from growing (see ScalableBloomFilter).
 #define MAX_BUFFER_SIZE 1000000         // Maximum size for buffers
 #define MAX_MONITORS 250
 #define MAX_THREADS 1000
 #define MAX_ID_DIGITS 5                 // Maximum number of digits allowed in Citizen ID's
+#define ID_BITS 17                      // Citizen ID's (up to MAX_ID_DIGITS digits) fit in this many bits
 #define MAX_BLOOM_SIZE 1000000          // Maximum Bloom Filter size allowed
+#define FILE_INDEX_BUCKETS 1000         // Number of buckets for the file name index of each directory
+#define WATCH_INDEX_BUCKETS 100         // Number of buckets for the watch descriptor index of the watched directories
+#define MIN_YEAR 1990                   // Valid Dates are between 1-1-MIN_YEAR and 30-12-MAX_YEAR
+#define MAX_YEAR 2100
+#define DAYS_PER_MONTH 30
+#define DAYS_PER_YEAR 360
+#define AGE_GROUPS 4                    // [0-19], [20-39], [40-59], 60+
+#define SCAN_CHUNK_BYTES 262144         // Larger files are split in chunks of this size, scanned by different threads
 
 /* Defined Message Type codes. */
 #define TRAVEL_REQUEST 1
@@ -30,13 +48,42 @@
 #define CITIZEN_FOUND 6
 #define CITIZEN_NOT_FOUND 7
 #define MONITOR_EXIT 8
+#define MONITOR_START 9                 // Sent to a new Monitor, which must scan all the files
+#define MONITOR_RESTORE 10              // Sent to a Monitor that replaces a dead one (it may load its snapshot)
+#define POPULATION_STATUS 11            // Request for the vaccinated/total population of each age group, per country
+#define MONITOR_STATS 12                // Request for the runtime statistics of the Monitor
+#define TRAVEL_REQUEST_NOT_VACCINATED 13    // Rejected Travel Request, because the citizen has no vaccination record
+#define BLOOM_FILTER_REQUEST 14         // Request for the Bloom Filter of a Virus, rebuilt with the specified size & Hash Functions
+#define BLOOM_FILTERS 15                // Precedes the (Scalable) Bloom Filters sent by a Monitor
+#define ID_BITMAPS 16                   // Precedes the vaccinated citizen ID bitmaps sent by a Monitor (instead of Bloom Filters)
+#define VACCINATED_COUNTS 17            // Precedes the number of vaccinated citizens of each Virus, sent before building the Bloom Filters
+
+/* Travel Request answers (of the Monitors, or the Parent when it uses a cached vaccination date). */
+#define TRAVEL_ACCEPTED_ANSWER "REQUEST ACCEPTED - HAPPY TRAVELS\n"
+#define TRAVEL_VACCINATION_NEEDED_ANSWER "REQUEST REJECTED - YOU WILL NEED ANOTHER VACCINATION BEFORE TRAVEL DATE\n"
+
+/* Monitor operations with separate latency histograms (in the order they are sent in MONITOR_STATS answers). */
+#define STATS_TRAVEL_REQUEST 0
+#define STATS_SEARCH_STATUS 1
+#define STATS_POPULATION_STATUS 2
+#define STATS_FILE_UPDATE 3             // Scanning the new files & sending the Bloom Filter updates
+#define STATS_MONITOR_OPERATIONS 4
+
+// Country directory placement policies (-a argument of the Parent)
+#define PLACEMENT_ROUND_ROBIN 0         // "rr": directories are assigned to Monitors in Round-Robin style
+#define PLACEMENT_SIZE 1                // "size": directories are assigned to Monitors balancing their total bytes
+
+// Membership modes (-f argument of the Parent & the Monitors)
+#define MEMBERSHIP_BLOOM 0              // "bloom": the Parent checks the merged Bloom Filters of the Monitors
+#define MEMBERSHIP_EXACT 1              // "exact": the Parent checks the exact vaccinated citizen ID's (see RoaringBitmap)
 
 class LinkedList;
-class RedBlackTree;
-class RBTreeNode;
 class SkipList;
 class BloomFilter;
+class ScalableBloomFilter;
+class RoaringBitmap;
 class HashTable;
+class FenwickTree;
 
 /**
  * Used for Date representation.
@@ -59,6 +106,26 @@ class Date
         void set6monthsPrior(const Date &other);
 };
 
+/**
+ * Counts events (e.g. Travel Requests) by Date. A Fenwick Tree stores the yearly counts,
+ * and there is a Fenwick Tree with the daily counts of each year that has any events
+ * (created when the first event of the year is added), so the events in any Date range
+ * are counted in O(log days).
+ */
+class DateCounter
+{
+    private:
+        FenwickTree *years;             // The yearly counts (index 0 is MIN_YEAR)
+        FenwickTree **days;             // The daily counts of each year (NULL if the year has no events)
+        unsigned int countBefore(const Date &date) const;
+    public:
+        DateCounter();
+        ~DateCounter();
+        void add(const Date &date, int value);
+        unsigned int count(const Date &start, const Date &end) const;
+        unsigned int total() const;
+};
+
 class CountryStatus;
 /**
  * Used for Citizen Representation.
@@ -99,16 +166,23 @@ class VirusRecords
     private:
         SkipList *vaccinated;       // Skip List for vaccinated persons
         SkipList *non_vaccinated;   // Skip List for not vaccinated persons        
+        const unsigned long max_filter_bytes;   // The maximum size of each Bloom Filter (stage)
     public:
-        BloomFilter *filter;        // Bloom Filter for fast citizen lookup
+        ScalableBloomFilter *filter;    // (Scalable) Bloom Filter for fast citizen lookup
+        RoaringBitmap *vaccinated_ids;  // The exact ID's of the vaccinated citizens (sent in MEMBERSHIP_EXACT mode)
         char *virus_name;           // The name of the Virus.
         VirusRecords(char *name, int skip_list_layers, unsigned long filter_bytes);
         ~VirusRecords();
         bool insertRecordOrShowExisted(VaccinationRecord *record, VaccinationRecord**present, bool &modified,
                                        FILE *fstream);
         bool checkBloomFilter(char *citizenID) const;
+        void rebuildFilter(unsigned long filter_bytes, unsigned int num_hashes, unsigned long shared_items = 0);
+        void resizeFilter(unsigned long max_bytes);
+        unsigned long countVaccinated() const;
         void getVaccinationStatusString(int citizenID, std::string &msg_str) const;
         VaccinationRecord *getVaccinationRecord(int citizenID) const;
+        const SkipList* getVaccinatedList() const;
+        const SkipList* getNonVaccinatedList() const;
 };
 
 /**
@@ -117,15 +191,8 @@ class VirusRecords
 class VirusCountryStatus
 {
     private:
-        void getTotalStatsRec(int &total, Date start,  Date end, RBTreeNode *root) const;
-        void getAgeStatsRec(int &bellow_20, int &between20_40, int &between40_60,
-                            int &plus60, Date start, Date end, RBTreeNode *root) const;
-        void getAgeStatsRec(int &bellow_20, int &between20_40, int &between40_60,
-                            int &plus60, RBTreeNode *root) const;
-        void updateAgeCounter(int age, int &bellow_20, int &between20_40, 
-                              int &between40_60, int &plus60) const;
-        RedBlackTree *record_tree;      // A Red-Black Tree that contains all the Vaccination Records
-                                        // of *vaccinated* persons in the country for this Virus.
+        DateCounter *vaccinations[AGE_GROUPS];  // The number of vaccinated persons of each age group, per day
+                                                // (from the "YES" Records of Citizens of this Country, for this Virus)
     public:
         int total_population;           // Number of Records (both YES/NO) associated with this Virus and Citizens of this Country
         int population_bellow_20;       // Number of such Records for each Age Group
@@ -135,7 +202,7 @@ class VirusCountryStatus
         char *virus_name;               // The name of the virus.
                                         // Note than this is the *exact same* character array address
                                         // stored in VirusRecords for this Virus.
-        VirusCountryStatus(char *name, CompareFunc tree_func);
+        VirusCountryStatus(char *name);
         ~VirusCountryStatus();
         void storeVaccinationRecord(VaccinationRecord *record);
         void updatePopulation(CitizenRecord *citizen);
@@ -161,21 +228,65 @@ class CountryStatus
         ~CountryStatus();
         void storeCitizenVaccinationRecord(VaccinationRecord *record);
         void storeNewVaccinationRecord(VaccinationRecord *record);
+        const VirusCountryStatus* getVirusStatus(const char *virus_name) const;
 };
 
+/**
+ * Used by child Monitors to store information about a file in an assigned directory.
+ */
+class FileInfo
+{
+    public:
+        char *name;                         // The file name
+        off_t size;                         // The file size when the file was last checked (-1 if never checked)
+        time_t mtime;                       // The file modification time when the file was last checked
+        off_t offset;                       // The number of bytes that have been scanned (up to the last complete line)
+        bool notified;                      // TRUE if the file has been reported by the watcher since the last update
+        FileInfo(const char *file_name);
+        ~FileInfo();
+};
+
+class DirectoryWatcher;
+
 /**
  * Used by child Monitors to store information about assigned country directories.
  */
 class DirectoryInfo
 {
-        unsigned short int numContents;     // Number of files in the directory
+        HashTable *index;                   // The directory contents, indexed by file name
+        LinkedList *notified_files;         // Files reported by the watcher since the last update (not owned)
+        bool rescan_needed;                 // TRUE if watch events of the directory may have been lost
+        void rescanContents(LinkedList *changed_files);
+        FileInfo* addFile(const char *name);
+        bool checkFile(FileInfo *file) const;
     public:
         const char *path;                   // The full path of the directory
-        LinkedList *contents;               // The directory contents (a list of file names)
+        LinkedList *contents;               // The directory contents (a list of FileInfo objects)
+        int watch_descriptor;               // The watch of the directory in the DirectoryWatcher (-1 if not watched)
         DirectoryInfo(const char *path);
         ~DirectoryInfo();
-        void addContents();
-        void updateContents();
+        FileInfo* getFile(const char *name) const;
+        void addContents(DirectoryWatcher *watcher);
+        void notifyFile(const char *name);
+        void requestRescan();
+        void updateContents(LinkedList *changed_files);
+};
+
+/**
+ * Watches all the country directories of a Monitor for files that are created/moved/written/appended in them,
+ * using a single inotify instance (so the number of instances does not grow with the number of directories).
+ * The watched DirectoryInfo objects are indexed by their watch descriptor.
+ */
+class DirectoryWatcher
+{
+        int watch_fd;                       // The inotify instance (-1 if not used)
+        HashTable *watched;                 // The watched directories, indexed by watch descriptor (not owned)
+        LinkedList *directories;            // The watched directories (not owned)
+    public:
+        DirectoryWatcher();
+        ~DirectoryWatcher();
+        void addDirectory(DirectoryInfo *dir);
+        void readEvents();
 };
 
 /**
@@ -183,6 +294,8 @@ class DirectoryInfo
  */
 
 char* copyString(const char *str);
+void writeString(FILE *file, const char *string);
+bool readString(FILE *file, char *&string, uint16_t &string_size);
 int citizenHashObject(void *citizen);
 
 // Comparison functions take void* arguments
@@ -196,9 +309,13 @@ int compareIdToCitizen(void *id, void *citizen_record);
 int compareCitizens(void *a, void *b);
 int compareNameVirusRecord(void *name, void *virus_record);
 int compareVaccinationRecordsByCitizen(void *a, void *b);
-int compareVaccinationsDateFirst(void *a, void *b);
 int compareNameVirusCountryStatus(void *name, void *virus_status);
 int compareNameCountryStatus(void *name, void *country_status);
+int compareNameFileInfo(void *name, void *file_info);
+int fileNameHashObject(const char *name);
+int fileInfoHashObject(void *file_info);
+int compareWatchDirectory(void *watch_descriptor, void *dir);
+int directoryWatchHashObject(void *dir);
 
 void displayVaccinationCitizen(void *record);
 
@@ -207,7 +324,7 @@ void displayVaccinationCitizen(void *record);
  */
 
 void displayMessage(FILE *fstream, const char *format, ...);
-void insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *country_name, unsigned short int age,
+bool insertVaccinationRecord(unsigned int citizen_id, char *full_name, char *country_name, unsigned short int age,
                              char *virus_name, bool vaccinated, Date &date,
                              LinkedList *countries, LinkedList *viruses, HashTable *citizens,
                              unsigned long bloom_bytes, FILE *fstream);
@@ -24,25 +24,84 @@
 
 #include "../include/linked_list.hpp"
 #include "../include/hash_table.hpp"
+#include "../include/bloom_filter.hpp"
+#include "../include/scalable_bloom_filter.hpp"
+#include "../include/roaring_bitmap.hpp"
 #include "../include/utils.hpp"
 #include "../include/messaging.hpp"
+#include "../include/stats.hpp"
 #include "app_utils.hpp"
 #include "parse_utils.hpp"
 #include "sem_utils.hpp"
+#include "snapshot_utils.hpp"
+#include "record_file.hpp"
 
 #define PERMS 0660
 
 #define CONNECTION_TIMEOUT_SECS 5
 #define HASHTABLE_BUCKETS 10000         // Number of buckets for the Citizen Hash Table
+#define SNAPSHOT_PATH_PREFIX "./snapshots/monitor_snapshot."
+#define SNAPSHOT_INTERVAL_SECS 5        // The snapshot is written this long after an update (once for all the updates in the meantime)
+#define INSERT_BATCH_RECORDS 256        // Parsed records are inserted in batches of (up to) this many records
 
 int dir_update_notifications = 0;       // Incremented when the Parent has send a signal that indicates directory files update
 int pending_messages = 0;       // Incremented when the Parent has send a signal that indicates pending information request
+int snapshot_alarms = 0;                // Incremented when the snapshot interval has passed (SIGALRM)
 bool terminate = false;                 // Set to true when SIGINT/SIGQUIT received
 
 unsigned int ftok_id;
 int sem_id;
 int first_not_consumed;                 // The index of the first buffer element that has not been consumed
 int cyclic_buffer_elements;             // total_elements - 1 is the index of the last element to be consumed
+int completed_elements;                 // The number of consumed elements that have been fully scanned
+
+// Runtime statistics (reported to the Parent in MONITOR_STATS answers)
+Counter records_parsed;                 // Records read from the files (text lines or binary records)
+Counter records_rejected;               // Records that could not be parsed, or were not stored
+LatencyHistogram operation_latencies[STATS_MONITOR_OPERATIONS];
+
+/**
+ * A cyclic buffer element: a byte range (chunk) of a file to be scanned.
+ * A chunk contains the lines that start in [start, end), so a line crossing
+ * the end of a chunk is scanned as part of that chunk.
+ */
+struct ScanTask {
+    char *path;             // The full path of the file
+    FileInfo *file;         // The FileInfo of the file (owned by its DirectoryInfo)
+    off_t start;            // The first byte of the chunk
+    off_t end;              // The first byte after the chunk
+    bool first;             // TRUE if this is the first chunk of the file (start is the beginning of a line)
+    bool scanned;           // TRUE if the chunk was scanned successfully
+    off_t scanned_offset;   // The offset that the next scan of the file can start from (-1 if the chunk does not set it)
+    bool complete_file;     // TRUE if a final line without newline is taken as complete (see scanTextChunk)
+
+    ScanTask(const char *dir_path, FileInfo *file_info, off_t chunk_start, off_t chunk_end, bool is_complete) :
+        path(new char[strlen(dir_path) + strlen(file_info->name) + 2]),
+        file(file_info),
+        start(chunk_start),
+        end(chunk_end),
+        first(chunk_start == file_info->offset),
+        scanned(false),
+        scanned_offset(-1),
+        complete_file(is_complete)
+        {
+            sprintf(path, "%s/%s", dir_path, file_info->name);
+        }
+    ~ScanTask() { delete[] path; }
+};
+
+/**
+ * A parsed Vaccination Record, waiting to be inserted.
+ */
+struct ParsedRecord {
+    int citizen_id;
+    int age;
+    char *citizen_name;
+    char *country_name;
+    char *virus_name;
+    bool vaccinated;
+    Date date;
+};
 
 /**
  * The struct to be passed to the threads, with all the required structures
@@ -53,11 +112,11 @@ struct ThreadArgs {
     LinkedList *countries;
     LinkedList *viruses;
     unsigned long bloom_size;
-    char **cyclic_buffer;
+    ScanTask **cyclic_buffer;
     int thread_num;
 
     ThreadArgs(HashTable *cit, LinkedList *countr, LinkedList *v,
-               unsigned long bloom_s, char **buffer, int i) :
+               unsigned long bloom_s, ScanTask **buffer, int i) :
         citizens(cit),
         countries(countr),
         viruses(v),
@@ -79,6 +138,12 @@ void sigusr2_handler(int s)
     signal(SIGUSR2, sigusr2_handler);
 }
 
+void sigalrm_handler(int s)
+{
+    snapshot_alarms++;
+    signal(SIGALRM, sigalrm_handler);
+}
+
 void sigint_handler(int s)
 {
     terminate = true;
@@ -120,11 +185,12 @@ bool socketConnect(int &socket_fd, uint16_t port)
 /**
  * Release the Monitor resources.
  */
-void releaseResources(char *buffer, DirectoryInfo **directories, unsigned short int num_dirs,
+void releaseResources(char *buffer, DirectoryInfo **directories, DirectoryWatcher *watcher, unsigned short int num_dirs,
                       HashTable *citizens, LinkedList *countries, LinkedList *viruses,
                       int socket_fd, pthread_t *threads, unsigned int num_threads)
 {
     delete[] buffer;
+    delete watcher;
     for (unsigned short i = 0; i < num_dirs; i++)
     {
         delete directories[i];
@@ -143,77 +209,210 @@ void releaseResources(char *buffer, DirectoryInfo **directories, unsigned short
     delete[] threads;    
 }
 
+/**
+ * Inserts the given parsed records in the Monitor structures (holding the insertion semaphore),
+ * and then deletes their strings.
+ */
+void insertParsedRecords(ParsedRecord *records, unsigned int &num_records, ThreadArgs *args)
+{
+    unsigned int rejected = 0;
+    sem_down(sem_id, 3);
+    for (unsigned int i = 0; i < num_records; i++)
+    {
+        if (!insertVaccinationRecord(records[i].citizen_id, records[i].citizen_name, records[i].country_name, records[i].age,
+                                     records[i].virus_name, records[i].vaccinated, records[i].date,
+                                     args->countries, args->viruses, args->citizens, args->bloom_size, NULL))
+        {
+            rejected++;
+        }
+    }
+    sem_up(sem_id, 3);
+    records_rejected.add(rejected);
+    for (unsigned int i = 0; i < num_records; i++)
+    {
+        delete[] records[i].citizen_name;
+        delete[] records[i].country_name;
+        delete[] records[i].virus_name;
+    }
+    num_records = 0;
+}
+
+/**
+ * Inserts all the records of the given binary record file (holding the insertion semaphore).
+ */
+void scanRecordFile(FILE *input_file, ThreadArgs *args)
+{
+    RecordFileReader reader(input_file);
+    unsigned int citizen_id;
+    unsigned short int age;
+    char *citizen_name, *country_name, *virus_name;
+    bool vaccinated;
+    Date date;
+    unsigned int parsed = 0, rejected = 0;
+
+    sem_down(sem_id, 3);
+    while (reader.readRecord(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date))
+    {
+        parsed++;
+        if (!insertVaccinationRecord(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date,
+                                     args->countries, args->viruses, args->citizens, args->bloom_size, NULL))
+        {
+            rejected++;
+        }
+    }
+    sem_up(sem_id, 3);
+    records_parsed.add(parsed);
+    records_rejected.add(rejected);
+}
+
+/**
+ * @brief Scans the lines of the given text file chunk for Vaccination Records.
+ * The lines are parsed without holding any semaphore, and the parsed records are inserted in batches.
+ * The offset of the end of the last complete (terminated by newline) line of the chunk is stored in
+ * task->scanned_offset (it remains -1 if the chunk does not contain the end of any complete line).
+ * A final line without newline may still be incomplete (e.g. it is being appended), so it is left for a later scan,
+ * once it has been terminated, unless task->complete_file is set: then it is parsed and the offset is moved past it.
+ * 
+ * @returns TRUE if the chunk was scanned, FALSE if it could not be read.
+ */
+bool scanTextChunk(FILE *input_file, ScanTask *task, ThreadArgs *args, ParsedRecord *records)
+{
+    off_t position = task->start;
+    if (!task->first)
+    // The chunk may start in the middle of a line, which belongs to the previous chunk,
+    // so skip anything up to the first newline after the previous byte.
+    {
+        if (fseeko(input_file, task->start - 1, SEEK_SET) != 0) { return false; }
+        int c;
+        position--;
+        while ( (c = fgetc(input_file)) != '\n' )
+        {
+            // The rest of the chunk is part of a line of the previous chunk
+            if (c == EOF) { return true; }
+            position++;
+        }
+        position++;
+    }
+    else if (fseeko(input_file, task->start, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    unsigned int num_records = 0;
+    unsigned int parsed = 0, rejected = 0;      // Added to the global counters once the chunk has been scanned
+    char *line_buf, *temp, *saveptr;
+    while (position < task->end)
+    // Read the lines that start in the chunk
+    {
+        line_buf = fgetline(input_file);
+        // If the line is not terminated by newline, it is the last line of the file, and it may still be incomplete
+        bool terminated = !feof(input_file);
+        if (line_buf == NULL)
+        // Empty line
+        {
+            if (!terminated) { break; }
+            position++;
+            continue;
+        }
+        if (!terminated && !task->complete_file)
+        // Not parsed (nor counted) until it is terminated, so that it is inserted only once
+        {
+            free(line_buf);
+            break;
+        }
+        position += strlen(line_buf) + (terminated ? 1 : 0);
+        parsed++;
+
+        temp = new char[strlen(line_buf) + 3];
+        sprintf(temp, "~ %s", line_buf);            // just a "hack" so that the parsing function
+                                                    // can get all the line tokens using strtok_r.
+        strtok_r(temp, " ", &saveptr);
+        ParsedRecord &record = records[num_records];
+        // Parse the line
+        if (insertCitizenRecordParse(record.citizen_id, record.citizen_name, record.country_name, record.age,
+                                     record.virus_name, record.vaccinated, record.date, NULL, &saveptr))
+        // If parsing was successful, the record will be inserted with the next batch
+        {
+            if (++num_records == INSERT_BATCH_RECORDS)
+            {
+                insertParsedRecords(records, num_records, args);
+            }
+        }
+        else
+        {
+            rejected++;
+            delete[] record.citizen_name;
+            delete[] record.country_name;
+            delete[] record.virus_name;
+        }
+        delete[] temp;
+        free(line_buf);
+        if (!terminated) { break; }
+    }
+    insertParsedRecords(records, num_records, args);
+    records_parsed.add(parsed);
+    records_rejected.add(rejected);
+    task->scanned_offset = position;
+    return true;
+}
+
 /**
  * @brief The cyclic buffer consuming threads routine.
  * 
- * Attempts to consume a file path from the given buffer.
- * If a path is successfully consumed, the file is opened and scanned for new Vaccination Records.
- * If the buffer is found as fully consumed, the parent thread will be notified
- * to place more file paths in it.
+ * Waits until a buffer element (file chunk) is available, and consumes it.
+ * The chunk is scanned for new Vaccination Records without holding the buffer semaphore,
+ * so that all the threads scan chunks at the same time (the chunks of a large file are
+ * scanned by whichever threads are idle). When all the elements of the buffer have been
+ * scanned, the parent thread is notified to place more elements in it.
  * 
  * @param arguments A dynamically created ThreadArgs struct.
  */
 void* fileScanner(void *arguments)
 {
     ThreadArgs *args = static_cast<ThreadArgs*>(arguments);
-    int citizen_id, age;
-    char *citizen_name, *country_name, *virus_name, *line_buf, *buf_copy, *temp;
-    bool vaccinated;
-    Date date;
+    ParsedRecord *records = new ParsedRecord[INSERT_BATCH_RECORDS];
     FILE *input_file;
-    // Attempt to consume a buffer element
-    while(sem_down(sem_id, 0) != -1)
+    // Wait for an available buffer element
+    while(sem_down(sem_id, 2) != -1)
     {
-        if (first_not_consumed == cyclic_buffer_elements)
-        // No available elements
+        // Consume the element
+        sem_down(sem_id, 0);
+        ScanTask *task = args->cyclic_buffer[first_not_consumed];
+        #ifdef SHOW_CYCLIC_BUFFER_MSG
+        printf("index: %d\n", first_not_consumed);
+        printf("Thread %d: %s (bytes %ld-%ld)\n", args->thread_num, task->path, (long)task->start, (long)task->end);
+        #endif
+        // Mark the next element as the first not consumed element
+        first_not_consumed++;
+        sem_up(sem_id, 0);
+
+        // Open the file in the buffer element path.
+        // The results are stored in the task, and the scanned offset of the file is updated
+        // once all the chunks have been scanned (see updateScannedOffsets).
+        input_file = fopen(task->path, "r");
+        if (input_file != NULL && isRecordFile(input_file)) {
+            // Binary record file, so the records are inserted without any parsing.
+            // Binary record files are always read as a whole, by the thread that consumes the first chunk.
+            if (task->first)
+            {
+                scanRecordFile(input_file, args);
+                task->scanned_offset = ftello(input_file);
+            }
+            task->scanned = true;
+        }
+        else if (input_file != NULL) {
+            task->scanned = scanTextChunk(input_file, task, args, records);
+        }
+        if (input_file != NULL) {
+            fclose(input_file);
+        }
+
+        sem_down(sem_id, 0);
+        bool buffer_scanned = (++completed_elements == cyclic_buffer_elements);
+        sem_up(sem_id, 0);
+        if (buffer_scanned)
+        // So notify the parent thread that the buffer can be filled again
         {
-            // So notify the parent thread that the buffer is empty
             sem_up(sem_id, 1);
-            // And continue with the loop
-        }
-        else
-        // There is an available element
-        {
-            #ifdef SHOW_CYCLIC_BUFFER_MSG
-            printf("index: %d\n", first_not_consumed);
-            printf("Thread %d: %s\n", args->thread_num, args->cyclic_buffer[first_not_consumed]);
-            #endif
-
-            // Open the file in the buffer element path
-            input_file = fopen(args->cyclic_buffer[first_not_consumed], "r");
-            if (input_file != NULL) {
-                // Read records from the file
-                while( (line_buf = fgetline(input_file)) != NULL)
-                // Read the file line by line
-                {
-                    buf_copy = new char[strlen(line_buf) + 1];
-                    temp = new char[strlen(line_buf) + 3];
-                    sprintf(temp, "~ %s", line_buf);            // just a "hack" so that the parsing function
-                                                                // can get all the line tokens using strtok.
-                    strcpy(buf_copy, line_buf);
-                    
-                    strtok(temp, " ");       
-
-                    // Parse the line
-                    if (insertCitizenRecordParse(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date, NULL))
-                    // If parsing was successful, try to insert the Record.
-                    {
-                        insertVaccinationRecord(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date,
-                                                args->countries, args->viruses, args->citizens, args->bloom_size, NULL);
-                    }
-                    delete[] citizen_name;
-                    delete[] country_name;
-                    delete[] virus_name;
-                    delete[] temp;
-                    delete[] buf_copy;
-                    free(line_buf);
-                }
-                fclose(input_file);
-            }
-            // Mark the next element as the first not consumed element
-            first_not_consumed++;
-            // End of critical section
-            sem_up(sem_id, 0);
         }
     }
     // At this point we expect that the semaphore set has been deleted by
@@ -223,147 +422,163 @@ void* fileScanner(void *arguments)
     {
         perror("semdown");
     }
+    delete[] records;
     delete args;
     pthread_exit(NULL);
 }
 
 /**
- * Scans all the files in the given directories and inserts any Vaccination Records found.
+ * Appends ScanTasks for the specified file of the specified directory in tasks,
+ * unless the file has already been scanned up to its current size.
+ * The part of the file that has not been scanned yet is split in chunks of SCAN_CHUNK_BYTES.
+ * If complete_file is TRUE, a final line without newline is taken as complete (see scanTextChunk).
  */
-void scanAllFiles(DirectoryInfo **directories, unsigned short int num_dirs,
-                        HashTable *citizens, LinkedList *countries, LinkedList *viruses,
-                        unsigned long bloom_size, char **cyclic_buffer, unsigned int cyclic_buffer_size,
-                        unsigned int num_threads, pthread_t *threads)
+void addScanTask(LinkedList *tasks, DirectoryInfo *directory, FileInfo *file, bool complete_file)
 {
-    // All files will be stored here
-    LinkedList files(delete_object_array<char>);
-    
-    // Iterate over the directories
-    for (unsigned short i = 0; i < num_dirs; i++)
+    if (file->offset > file->size)
+    // The file has been truncated or replaced, so it will be scanned from its beginning
     {
-        // Iterate over the contents of each directory
-        LinkedList::ListIterator itr = directories[i]->contents->listHead();
-        while (!itr.isNull())
-        {
-            // Create the full path of the file in order to open it
-            char *file_path = new char[strlen(directories[i]->path) + strlen((char*)itr.getData()) + 2];
-            sprintf(file_path, "%s/%s", directories[i]->path, (char*)itr.getData());
-            files.append(file_path);
-            itr.forward();
-        }        
+        file->offset = 0;
     }
-    // Create semaphore set
-    key_t sem_key = ftok(".", ftok_id);
-    // Get 2 semapthores
-    if ( (sem_id = semget(sem_key, 2, IPC_CREAT|PERMS)) < 0)
+    for (off_t start = file->offset; start < file->size; start += SCAN_CHUNK_BYTES)
     {
-        perror("Failed to create semaphore set");
-        exit(EXIT_FAILURE);
+        off_t end = (file->size - start > SCAN_CHUNK_BYTES) ? (start + SCAN_CHUNK_BYTES) : file->size;
+        tasks->append(new ScanTask(directory->path, file, start, end, complete_file));
     }
-    // Initialize semaphore 0 to 0, and semaphore 1 to 1.
-    sem_init(sem_id, 0, 0);     // when this is up, it means someone can safely read (or attempt to read)
-    sem_init(sem_id, 1, 1);     // when this is up, it means the parent thread can fill up the buffer with new files
-    for (unsigned int i = 0; i < num_threads; i++)
+}
+
+/**
+ * Updates the scanned offset of the file of each of the given (scanned) ScanTasks.
+ * The chunks of a file may be scanned in any order, so the offset is only advanced over
+ * the chunks at the start of the file part that were all scanned successfully: if a chunk could not be
+ * scanned, the next scan of the file starts from it (even if the chunks after it were scanned).
+ * The ScanTasks of each file must be consecutive and in file order (see addScanTask).
+ */
+void updateScannedOffsets(LinkedList *tasks)
+{
+    FileInfo *blocked_file = NULL;      // A file with a chunk that was not scanned
+    for (LinkedList::ListIterator itr = tasks->listHead(); !itr.isNull(); itr.forward())
     {
-        // Each thread handles its own argument struct, and deletes it before terminating.
-        pthread_create(&threads[i], NULL, fileScanner, new ThreadArgs(citizens, countries, viruses, bloom_size, cyclic_buffer, i));
+        ScanTask *task = static_cast<ScanTask*>(itr.getData());
+        if (task->file == blocked_file) { continue; }
+        if (!task->scanned)
+        {
+            blocked_file = task->file;
+            continue;
+        }
+        if (task->scanned_offset > task->file->offset)
+        {
+            task->file->offset = task->scanned_offset;
+        }
     }
-    // Start iterating over the files
-    LinkedList::ListIterator itr = files.listHead();
+}
+
+/**
+ * Places the given ScanTasks in the cyclic buffer (as many as it fits each time),
+ * and waits until all of them have been scanned by the threads.
+ * The scanned offsets of the files are updated afterwards (see updateScannedOffsets).
+ */
+void produceScanTasks(LinkedList *tasks, ScanTask **cyclic_buffer, unsigned int cyclic_buffer_size)
+{
+    LinkedList::ListIterator itr = tasks->listHead();
     while(!itr.isNull())
     {
-        // Attempt to fill up buffer with new files
-        sem_down(sem_id, 1);
-
         #ifdef SHOW_CYCLIC_BUFFER_MSG
         printf("Now producing\n");
         #endif
 
         int i;
-        // Fill up the buffer with new files (or place them all if the buffer has enough space)
+        // Fill up the buffer with new tasks (or place them all if the buffer has enough space)
         for (i = 0; (i < cyclic_buffer_size) && (!itr.isNull()); itr.forward(), i++)
         {
-            cyclic_buffer[i] = static_cast<char*>(itr.getData());
+            cyclic_buffer[i] = static_cast<ScanTask*>(itr.getData());
         }
         // Make sure no one reads more than i elements
         cyclic_buffer_elements = i;
         first_not_consumed = 0;
+        completed_elements = 0;
 
-        // Notify the threads to consume the buffer elememts
-        sem_up(sem_id, 0);
+        // Notify the threads to consume the buffer elements
+        for (int j = 0; j < i; j++)
+        {
+            sem_up(sem_id, 2);
+        }
+        // Wait till all elements have been scanned
+        sem_down(sem_id, 1);
     }
-    // Wait for all elements to be consumed
-    sem_down(sem_id, 1);
+    updateScannedOffsets(tasks);
 }
 
 /**
- * Checks if any new files have been added in any country directory,
- * and scans them for new Vaccination records.
+ * Scans all the files in the given directories and inserts any Vaccination Records found.
+ * Each file is scanned from the end of its already scanned part (e.g. loaded from a snapshot).
+ * The files are taken as complete, so a final line without newline is inserted as well.
  */
-void scanNewFiles(DirectoryInfo **directories, unsigned short int num_dirs,
-                  HashTable *citizens, LinkedList *countries, LinkedList *viruses,
-                  unsigned long bloom_size, char **cyclic_buffer, unsigned int cyclic_buffer_size)
+void scanAllFiles(DirectoryInfo **directories, unsigned short int num_dirs,
+                        HashTable *citizens, LinkedList *countries, LinkedList *viruses,
+                        unsigned long bloom_size, ScanTask **cyclic_buffer, unsigned int cyclic_buffer_size,
+                        unsigned int num_threads, pthread_t *threads)
 {
-    // All new files will be stored here
-    LinkedList files(delete_object_array<char>);
+    // All files will be stored here
+    LinkedList files(delete_object<ScanTask>);
     
     // Iterate over the directories
     for (unsigned short i = 0; i < num_dirs; i++)
     {
-        LinkedList::ListIterator *itr;
-        if (directories[i]->contents->isEmpty())
-        // The directory is empty
-        {
-            // So update and get an iterator to the beginning of the files list
-            directories[i]->updateContents();
-            itr = new LinkedList::ListIterator(directories[i]->contents->listHead());
-        }
-        else
-        // Directory is not empty
-        {
-            // Get iterator to the last already stored file
-            itr = new LinkedList::ListIterator(directories[i]->contents->listLast());
-            // Update files list
-            directories[i]->updateContents();
-            // Make the iterator point to the next element
-            // It will either be NULL (if no new files were added), or the first new file
-            itr->forward();
-        }
-
-        while (!itr->isNull())
+        // Iterate over the contents of each directory
+        for (LinkedList::ListIterator itr = directories[i]->contents->listHead(); !itr.isNull(); itr.forward())
         {
-            // Create the full path of the file in order to open it
-            char *file_path = new char[strlen(directories[i]->path) + strlen((char*)itr->getData()) + 2];
-            sprintf(file_path, "%s/%s", directories[i]->path, (char*)itr->getData());
-            files.append(file_path);
-            itr->forward();
+            addScanTask(&files, directories[i], static_cast<FileInfo*>(itr.getData()), true);
         }
-        delete itr;
     }
-    // Start iterating over the new files
-    LinkedList::ListIterator itr = files.listHead();
-    while(!itr.isNull())
+    // Create semaphore set
+    key_t sem_key = ftok(".", ftok_id);
+    // Get 4 semapthores
+    if ( (sem_id = semget(sem_key, 4, IPC_CREAT|PERMS)) < 0)
     {
-        // Semaphore 1 is already down, so new files can be added to the buffer
-        #ifdef SHOW_CYCLIC_BUFFER_MSG
-        printf("Now producing\n");
-        #endif
+        perror("Failed to create semaphore set");
+        exit(EXIT_FAILURE);
+    }
+    sem_init(sem_id, 0, 1);     // mutual exclusion for the buffer indexes
+    sem_init(sem_id, 1, 0);     // when this is up, it means the parent thread can fill up the buffer with new files
+    sem_init(sem_id, 2, 0);     // the number of buffer elements that have not been consumed
+    sem_init(sem_id, 3, 1);     // mutual exclusion for the record structures
+    for (unsigned int i = 0; i < num_threads; i++)
+    {
+        // Each thread handles its own argument struct, and deletes it before terminating.
+        pthread_create(&threads[i], NULL, fileScanner, new ThreadArgs(citizens, countries, viruses, bloom_size, cyclic_buffer, i));
+    }
+    produceScanTasks(&files, cyclic_buffer, cyclic_buffer_size);
+}
 
-        int i;
-        // Fill up the buffer with new files (or place them all if the buffer has enough space)
-        for (i = 0; (i < cyclic_buffer_size) && (!itr.isNull()); itr.forward(), i++)
+/**
+ * Checks if any new files have been added in any country directory (or any existing files have changed),
+ * and scans them for new Vaccination records. A final line without newline is left until it is terminated,
+ * since the file may still be being written.
+ */
+void scanNewFiles(DirectoryInfo **directories, DirectoryWatcher *watcher, unsigned short int num_dirs,
+                  HashTable *citizens, LinkedList *countries, LinkedList *viruses,
+                  unsigned long bloom_size, ScanTask **cyclic_buffer, unsigned int cyclic_buffer_size)
+{
+    // All new/changed files will be stored here
+    LinkedList files(delete_object<ScanTask>);
+    // Report the files of all the pending watch events to their directories
+    watcher->readEvents();
+    
+    // Iterate over the directories
+    for (unsigned short i = 0; i < num_dirs; i++)
+    {
+        // Get the new/changed files of the directory (the FileInfo objects are owned by the directory)
+        LinkedList changed_files(NULL);
+        directories[i]->updateContents(&changed_files);
+
+        for (LinkedList::ListIterator itr = changed_files.listHead(); !itr.isNull(); itr.forward())
         {
-            cyclic_buffer[i] = static_cast<char*>(itr.getData());
+            // Only the part of the file after its stored offset will be scanned
+            addScanTask(&files, directories[i], static_cast<FileInfo*>(itr.getData()), false);
         }
-        // Make sure no one reads more than i elements
-        cyclic_buffer_elements = i;
-        first_not_consumed = 0;
-
-        // Notify the threads to consume the buffer elememts
-        sem_up(sem_id, 0);
-        // Wait till all elements have been consumed
-        sem_down(sem_id, 1);
     }
+    produceScanTasks(&files, cyclic_buffer, cyclic_buffer_size);
 }
 
 /**
@@ -386,6 +601,7 @@ void serveTravelRequest(int socket_fd, char *buffer, unsigned int buffer_size,
     receiveString(socket_fd, virus_name, buffer, buffer_size);
     std::string answer;
     char answer_type;
+    VaccinationRecord *record = NULL;
 
     // Get the VirusRecords structure for the specified virus
     VirusRecords *virus = (VirusRecords*)viruses->getElement(virus_name, compareNameVirusRecord);
@@ -394,18 +610,18 @@ void serveTravelRequest(int socket_fd, char *buffer, unsigned int buffer_size,
     // Virus not found
     {
         answer.append("REQUEST REJECTED - YOU ARE NOT VACCINATED\n");
-        answer_type = TRAVEL_REQUEST_REJECTED;
+        answer_type = TRAVEL_REQUEST_NOT_VACCINATED;
         rejected_requests++;
     }
     else
     // Virus found
     {
         // Find record for this citizen
-        VaccinationRecord *record = static_cast<VaccinationRecord*>(virus->getVaccinationRecord(citizen_id));
+        record = static_cast<VaccinationRecord*>(virus->getVaccinationRecord(citizen_id));
         if (record == NULL)
         {
             answer.append("REQUEST REJECTED - YOU ARE NOT VACCINATED\n");
-            answer_type = TRAVEL_REQUEST_REJECTED;
+            answer_type = TRAVEL_REQUEST_NOT_VACCINATED;
             rejected_requests++;
         }
         else
@@ -414,13 +630,13 @@ void serveTravelRequest(int socket_fd, char *buffer, unsigned int buffer_size,
             // Check if the Vaccination date is not more than 6 months older
             if (record->date.isBetween(date6monthsPrior, date))
             {
-                answer.append("REQUEST ACCEPTED - HAPPY TRAVELS\n");
+                answer.append(TRAVEL_ACCEPTED_ANSWER);
                 answer_type = TRAVEL_REQUEST_ACCEPTED;
                 accepted_requests++;
             }
             else
             {
-                answer.append("REQUEST REJECTED - YOU WILL NEED ANOTHER VACCINATION BEFORE TRAVEL DATE\n");
+                answer.append(TRAVEL_VACCINATION_NEEDED_ANSWER);
                 answer_type = TRAVEL_REQUEST_REJECTED;
                 rejected_requests++;
             }            
@@ -429,6 +645,11 @@ void serveTravelRequest(int socket_fd, char *buffer, unsigned int buffer_size,
     // Send the answer type and the answer string
     sendMessageType(socket_fd, answer_type, buffer, buffer_size);
     sendString(socket_fd, answer.c_str(), buffer, buffer_size);
+    if (answer_type != TRAVEL_REQUEST_NOT_VACCINATED)
+    // Send the vaccination date as well, so that the Parent can decide the next requests of the citizen itself
+    {
+        sendDate(socket_fd, record->date, buffer, buffer_size);
+    }
 }
 
 /**
@@ -468,13 +689,98 @@ void serveSearchStatusRequest(int socket_fd, char *buffer, unsigned int buffer_s
     }
 }
 
+/**
+ * Sends the vaccinated & total population of each age group regarding the specified virus,
+ * for the given Country (only if it has information about the virus).
+ * Only the vaccinations between start and end are counted, unless the Dates are null.
+ */
+void sendCountryPopulationStatus(int socket_fd, char *buffer, unsigned int buffer_size,
+                                 CountryStatus *country, const VirusCountryStatus *virus_status, Date &start, Date &end)
+{
+    int vaccinated[AGE_GROUPS] = { 0 };
+    if (start.isNullDate())
+    {
+        virus_status->getVaccinationStatsByAge(vaccinated[0], vaccinated[1], vaccinated[2], vaccinated[3]);
+    }
+    else
+    {
+        virus_status->getVaccinationStatsByAge(vaccinated[0], vaccinated[1], vaccinated[2], vaccinated[3], start, end);
+    }
+    int population[AGE_GROUPS] = { virus_status->population_bellow_20, virus_status->population_20_40,
+                                   virus_status->population_40_60, virus_status->population_60_plus };
+
+    sendString(socket_fd, country->country_name, buffer, buffer_size);
+    for (unsigned int i = 0; i < AGE_GROUPS; i++)
+    {
+        sendInt(socket_fd, population[i], buffer, buffer_size);
+        sendInt(socket_fd, vaccinated[i], buffer, buffer_size);
+    }
+}
+
+/**
+ * Serves a /populationStatus or /popStatusByAge request.
+ * The statistics of every Country with information about the requested virus are sent
+ * (or only of the requested Country, if a Country name was sent).
+ */
+void servePopulationStatusRequest(int socket_fd, char *buffer, unsigned int buffer_size, LinkedList *countries)
+{
+    char *virus_name, *country_name;
+    Date start, end;
+    // Receive the virus name, the country name (empty for all countries) and the dates (null for all dates)
+    receiveString(socket_fd, virus_name, buffer, buffer_size);
+    receiveString(socket_fd, country_name, buffer, buffer_size);
+    receiveDate(socket_fd, start, buffer, buffer_size);
+    receiveDate(socket_fd, end, buffer, buffer_size);
+
+    // Inform how many countries will be sent
+    unsigned int num_countries = 0;
+    for (LinkedList::ListIterator itr = countries->listHead(); !itr.isNull(); itr.forward())
+    {
+        CountryStatus *country = static_cast<CountryStatus*>(itr.getData());
+        if ((country_name[0] == '\0' || strcmp(country_name, country->country_name) == 0) &&
+            country->getVirusStatus(virus_name) != NULL)
+        {
+            num_countries++;
+        }
+    }
+    sendInt(socket_fd, num_countries, buffer, buffer_size);
+
+    for (LinkedList::ListIterator itr = countries->listHead(); !itr.isNull(); itr.forward())
+    {
+        CountryStatus *country = static_cast<CountryStatus*>(itr.getData());
+        if (country_name[0] != '\0' && strcmp(country_name, country->country_name) != 0) { continue; }
+        const VirusCountryStatus *virus_status = country->getVirusStatus(virus_name);
+        if (virus_status != NULL)
+        {
+            sendCountryPopulationStatus(socket_fd, buffer, buffer_size, country, virus_status, start, end);
+        }
+    }
+    free(virus_name);
+    free(country_name);
+}
+
+/**
+ * Returns TRUE if the filter of the specified Virus that is sent in the given membership mode
+ * (its Bloom Filter or its vaccinated ID bitmap) has changed since it was last sent, FALSE otherwise.
+ */
+static bool hasFilterChanges(VirusRecords *virus, int membership)
+{
+    if (membership == MEMBERSHIP_EXACT)
+    {
+        return virus->vaccinated_ids->hasChanges();
+    }
+    return virus->filter->getNumChangedWords() > 0;
+}
+
 /**
  * Sends the Monitor bloom filters to the Parent process.
+ * In MEMBERSHIP_EXACT mode, the vaccinated ID bitmaps are sent instead.
  */
 void sendBloomFilters(int socket_fd, char *buffer, unsigned int buffer_size,
-                      LinkedList *viruses)
+                      LinkedList *viruses, int membership)
 {
-    // Inform how many bloom filters will be sent
+    // Inform what kind of filters & how many of them will be sent
+    sendMessageType(socket_fd, (membership == MEMBERSHIP_EXACT) ? ID_BITMAPS : BLOOM_FILTERS, buffer, buffer_size);
     sendInt(socket_fd, viruses->getNumElements(), buffer, buffer_size);    
 
     for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
@@ -482,9 +788,142 @@ void sendBloomFilters(int socket_fd, char *buffer, unsigned int buffer_size,
         VirusRecords *virus = static_cast<VirusRecords*>(itr.getData());
         // Send the name of the virus that the bloom filter refers to
         sendString(socket_fd, virus->virus_name, buffer, buffer_size);
-        // Send the bloom filter
+        // Send the bloom filter (or bitmap)
+        if (membership == MEMBERSHIP_EXACT)
+        {
+            sendIdBitmap(socket_fd, virus->vaccinated_ids, buffer, buffer_size);
+        }
+        else
+        {
+            sendBloomFilter(socket_fd, virus->filter, buffer, buffer_size);
+        }
+    }
+}
+
+/**
+ * Sends the changes in the Monitor bloom filters (since they were last sent) to the Parent process.
+ * Bloom filters without any changes are not sent at all.
+ * In MEMBERSHIP_EXACT mode, the changed containers of the vaccinated ID bitmaps are sent instead.
+ */
+void sendBloomFilterUpdates(int socket_fd, char *buffer, unsigned int buffer_size,
+                            LinkedList *viruses, int membership)
+{
+    // Inform what kind of filters & how many of them have changed
+    sendMessageType(socket_fd, (membership == MEMBERSHIP_EXACT) ? ID_BITMAPS : BLOOM_FILTERS, buffer, buffer_size);
+    unsigned int changed_filters = 0;
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        if (hasFilterChanges(static_cast<VirusRecords*>(itr.getData()), membership))
+        {
+            changed_filters++;
+        }
+    }
+    sendInt(socket_fd, changed_filters, buffer, buffer_size);
+
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusRecords *virus = static_cast<VirusRecords*>(itr.getData());
+        if (!hasFilterChanges(virus, membership)) { continue; }
+        // Send the name of the virus that the bloom filter refers to
+        sendString(socket_fd, virus->virus_name, buffer, buffer_size);
+        // Send the changed words of the bloom filter (or the changed containers of the bitmap)
+        if (membership == MEMBERSHIP_EXACT)
+        {
+            sendIdBitmapChanges(socket_fd, virus->vaccinated_ids, buffer, buffer_size);
+        }
+        else
+        {
+            sendBloomFilterChanges(socket_fd, virus->filter, buffer, buffer_size);
+        }
+    }
+}
+
+/**
+ * Sends the number of vaccinated persons of every Virus to the Parent, and rebuilds the Bloom Filter of each Virus
+ * with the size & number of Hash Functions (and the number of citizens in the merged filter) that the Parent answers with,
+ * so that the Parent can merge the filters of all the Monitors. If the Parent answers with zero size (i.e. it has no
+ * filter for this Virus yet), the filter is sized for the own number of vaccinated persons (see VirusRecords::resizeFilter).
+ * No filter exceeds max_bytes.
+ */
+void agreeBloomFilterParameters(int socket_fd, char *buffer, unsigned int buffer_size,
+                                LinkedList *viruses, unsigned long max_bytes)
+{
+    sendMessageType(socket_fd, VACCINATED_COUNTS, buffer, buffer_size);
+    sendInt(socket_fd, viruses->getNumElements(), buffer, buffer_size);
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusRecords *virus = static_cast<VirusRecords*>(itr.getData());
+        sendString(socket_fd, virus->virus_name, buffer, buffer_size);
+        sendInt(socket_fd, virus->countVaccinated(), buffer, buffer_size);
+    }
+    // The Parent answers after receiving the counts of all the Monitors, in the same order
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusRecords *virus = static_cast<VirusRecords*>(itr.getData());
+        unsigned int filter_bytes, num_hashes, shared_items;
+        receiveInt(socket_fd, filter_bytes, buffer, buffer_size);
+        receiveInt(socket_fd, num_hashes, buffer, buffer_size);
+        receiveInt(socket_fd, shared_items, buffer, buffer_size);
+        if (filter_bytes == 0)
+        {
+            virus->resizeFilter(max_bytes);
+        }
+        else
+        {
+            virus->rebuildFilter(filter_bytes, num_hashes, shared_items);
+        }
+    }
+}
+
+/**
+ * Serves a Bloom Filter request: the Bloom Filter of the specified Virus is rebuilt with the requested size
+ * & number of Hash Functions for its first stage (which are kept from now on), and it is sent to the Parent.
+ * The Parent also sends the number of citizens in its (merged) filter, which are counted in the rebuilt filter.
+ * The Parent requests this when the filter it received cannot be merged with the filters of the other Monitors.
+ */
+void serveBloomFilterRequest(int socket_fd, char *buffer, unsigned int buffer_size, LinkedList *viruses)
+{
+    char *virus_name = NULL;
+    unsigned int filter_bytes, num_hashes, shared_items;
+    receiveString(socket_fd, virus_name, buffer, buffer_size);
+    receiveInt(socket_fd, filter_bytes, buffer, buffer_size);
+    receiveInt(socket_fd, num_hashes, buffer, buffer_size);
+    receiveInt(socket_fd, shared_items, buffer, buffer_size);
+
+    VirusRecords *virus = static_cast<VirusRecords*>(viruses->getElement(virus_name, compareNameVirusRecord));
+    if (virus != NULL)
+    {
+        virus->rebuildFilter(filter_bytes, num_hashes, shared_items);
         sendBloomFilter(socket_fd, virus->filter, buffer, buffer_size);
     }
+    else
+    // No records about this Virus, so send an empty filter (the Parent is waiting for one)
+    {
+        ScalableBloomFilter empty(filter_bytes, num_hashes);
+        sendBloomFilter(socket_fd, &empty, buffer, buffer_size);
+    }
+    free(virus_name);
+}
+
+/**
+ * Serves a /stats request: sends the record counters, the traffic counters of each messaging routine
+ * and the latency histograms of the Monitor operations.
+ */
+void serveStatsRequest(int socket_fd, char *buffer, unsigned int buffer_size)
+{
+    sendLongInt(socket_fd, records_parsed.get(), buffer, buffer_size);
+    sendLongInt(socket_fd, records_rejected.get(), buffer, buffer_size);
+    for (unsigned int i = 0; i < TRAFFIC_ROUTINES; i++)
+    {
+        sendLongInt(socket_fd, sent_traffic[i].calls.get(), buffer, buffer_size);
+        sendLongInt(socket_fd, sent_traffic[i].bytes.get(), buffer, buffer_size);
+        sendLongInt(socket_fd, received_traffic[i].calls.get(), buffer, buffer_size);
+        sendLongInt(socket_fd, received_traffic[i].bytes.get(), buffer, buffer_size);
+    }
+    for (unsigned int i = 0; i < STATS_MONITOR_OPERATIONS; i++)
+    {
+        sendLatencyHistogram(socket_fd, operation_latencies[i], buffer, buffer_size);
+    }
 }
 
 /**
@@ -498,6 +937,7 @@ void serveRequest(int socket_fd, char *buffer, unsigned int buffer_size,
     char msg_type;
     // Receive the type of the request
     receiveMessageType(socket_fd, msg_type, buffer, buffer_size);
+    unsigned long long start = currentMicros();
 
     switch (msg_type)
     // Call the corresponding routine to serve it
@@ -505,9 +945,21 @@ void serveRequest(int socket_fd, char *buffer, unsigned int buffer_size,
         case TRAVEL_REQUEST:
             serveTravelRequest(socket_fd, buffer, buffer_size,
                                citizens, viruses, accepted_requests, rejected_requests);
+            operation_latencies[STATS_TRAVEL_REQUEST].add(currentMicros() - start);
             break;  
         case SEARCH_STATUS:
             serveSearchStatusRequest(socket_fd, buffer, buffer_size, citizens, viruses);
+            operation_latencies[STATS_SEARCH_STATUS].add(currentMicros() - start);
+            break;
+        case POPULATION_STATUS:
+            servePopulationStatusRequest(socket_fd, buffer, buffer_size, countries);
+            operation_latencies[STATS_POPULATION_STATUS].add(currentMicros() - start);
+            break;
+        case MONITOR_STATS:
+            serveStatsRequest(socket_fd, buffer, buffer_size);
+            break;
+        case BLOOM_FILTER_REQUEST:
+            serveBloomFilterRequest(socket_fd, buffer, buffer_size, viruses);
             break;
         case MONITOR_EXIT:
             terminate = true;
@@ -558,18 +1010,21 @@ int main(int argc, char const *argv[])
     // Register signal handlers
     signal(SIGUSR1, sigusr1_handler);
     signal(SIGUSR2, sigusr2_handler);
+    signal(SIGALRM, sigalrm_handler);
     signal(SIGINT, sigint_handler);
     signal(SIGQUIT, sigint_handler);
 
     int socket_fd;
     unsigned int num_dirs, buffer_size, cyclic_buffer_size, num_threads;
     unsigned long bloom_size;
+    int membership;
     uint16_t port;
     DirectoryInfo **directories;
+    DirectoryWatcher *watcher;
 
     // Check, parse and store the arguments
     if (!childCheckparseArgs(argc, argv, port, num_threads, buffer_size,
-                   cyclic_buffer_size, directories, bloom_size, num_dirs))
+                   cyclic_buffer_size, directories, watcher, bloom_size, membership, num_dirs))
     {
         exit(EXIT_FAILURE);
     }
@@ -587,14 +1042,37 @@ int main(int argc, char const *argv[])
     LinkedList *countries = new LinkedList(delete_object<CountryStatus>);
     LinkedList *viruses = new LinkedList(delete_object<VirusRecords>);
 
-    char **cyclic_buffer = new char*[cyclic_buffer_size];
+    ScanTask **cyclic_buffer = new ScanTask*[cyclic_buffer_size];
 
     receiveInt(socket_fd, ftok_id, buffer, buffer_size);
-    // Scan all the files and insert all records found
+
+    // The snapshot of this Monitor is stored here
+    std::stringstream snapshot_path_stream;
+    snapshot_path_stream << SNAPSHOT_PATH_PREFIX << ftok_id;
+    std::string snapshot_path = snapshot_path_stream.str();
+    char start_mode;
+    receiveMessageType(socket_fd, start_mode, buffer, buffer_size);
+    if (start_mode == MONITOR_RESTORE)
+    // This Monitor replaces a dead one, so try to load the records (and scanned file offsets) from its snapshot
+    {
+        if (!loadSnapshot(snapshot_path.c_str(), directories, num_dirs, citizens, countries, viruses, bloom_size))
+        {
+            fprintf(stderr, "Failed to load snapshot %s, scanning all files\n", snapshot_path.c_str());
+        }
+    }
+    // Scan all the (remaining parts of the) files and insert all records found
     scanAllFiles(directories, num_dirs, citizens, countries, viruses, bloom_size, cyclic_buffer, cyclic_buffer_size,
                  num_threads, threads);
-    // Send all the bloom filters to the parent process
-    sendBloomFilters(socket_fd, buffer, buffer_size, viruses);
+    if (membership == MEMBERSHIP_BLOOM)
+    // Size each bloom filter as the Parent decides, based on the number of vaccinated persons (bloom_size is the maximum size)
+    {
+        agreeBloomFilterParameters(socket_fd, buffer, buffer_size, viruses, bloom_size);
+    }
+    // Send all the bloom filters (or vaccinated ID bitmaps) to the parent process
+    sendBloomFilters(socket_fd, buffer, buffer_size, viruses, membership);
+    // The snapshot is written after the filters have been sent, so the Parent does not wait for it
+    writeSnapshot(snapshot_path.c_str(), directories, num_dirs, viruses);
+    bool snapshot_pending = false;          // TRUE if the records have changed since the snapshot was written
 
     // Travel request counters
     unsigned int accepted_requests = 0, rejected_requests = 0;
@@ -603,7 +1081,7 @@ int main(int argc, char const *argv[])
     while ( !terminate )
     {
         // No non-served signals for now
-        if (dir_update_notifications == 0 && pending_messages == 0)
+        if (dir_update_notifications == 0 && pending_messages == 0 && snapshot_alarms == 0)
         // Suspend the Monitor until any signal is received
         {
             pause();
@@ -612,8 +1090,17 @@ int main(int argc, char const *argv[])
         // Received indication that new files have been added in the given directories
         {
             dir_update_notifications--;
-            scanNewFiles(directories, num_dirs, citizens, countries, viruses, bloom_size, cyclic_buffer, cyclic_buffer_size);
-            sendBloomFilters(socket_fd, buffer, buffer_size, viruses);
+            unsigned long long start = currentMicros();
+            scanNewFiles(directories, watcher, num_dirs, citizens, countries, viruses, bloom_size,
+                         cyclic_buffer, cyclic_buffer_size);
+            sendBloomFilterUpdates(socket_fd, buffer, buffer_size, viruses, membership);
+            operation_latencies[STATS_FILE_UPDATE].add(currentMicros() - start);
+            if (!snapshot_pending)
+            // Write the snapshot later, so the updates in the meantime are included in the same snapshot
+            {
+                snapshot_pending = true;
+                alarm(SNAPSHOT_INTERVAL_SECS);
+            }
         }
         if (pending_messages > 0)
         // Received indication that the Parent process has requested informations
@@ -622,6 +1109,16 @@ int main(int argc, char const *argv[])
             serveRequest(socket_fd, buffer, buffer_size, citizens, countries, viruses,
                          accepted_requests, rejected_requests);
         }
+        if (snapshot_alarms > 0)
+        // The snapshot interval has passed since the first update after the last snapshot
+        {
+            snapshot_alarms = 0;
+            if (snapshot_pending)
+            {
+                writeSnapshot(snapshot_path.c_str(), directories, num_dirs, viruses);
+                snapshot_pending = false;
+            }
+        }
     }
 
     // By deleting the semaphore set, the threads will terminate (see fileScanner routine)
@@ -629,7 +1126,7 @@ int main(int argc, char const *argv[])
     // Create log file and release resouces
     createLogFile(accepted_requests, rejected_requests, countries);
     delete[] cyclic_buffer;
-    releaseResources(buffer, directories, num_dirs, citizens, countries, viruses, socket_fd,
+    releaseResources(buffer, directories, watcher, num_dirs, citizens, countries, viruses, socket_fd,
                      threads, num_threads);
 
     return 0;
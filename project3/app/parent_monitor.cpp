@@ -25,13 +25,17 @@
 #include "../include/messaging.hpp"
 #include "../include/linked_list.hpp"
 #include "../include/bloom_filter.hpp"
-#include "../include/rb_tree.hpp"
+#include "../include/stats.hpp"
 #include "parent_monitor_utils.hpp"
 #include "app_utils.hpp"
 #include "parse_utils.hpp"
+#include "request_log.hpp"
+
+#define REQUEST_LOG_PATH "./state/travel_requests.log"
 
 int sigchld_received = 0;               // If > 0, a child Monitor has died
 bool terminate = false;                 // Will be set to true to indicate termination
+LatencyHistogram command_latencies[PARENT_COMMANDS];   // The latencies of the executed commands (see /stats)
 
 void sigint_handler(int s)
 {
@@ -52,12 +56,15 @@ void sigchld_handler(int s)
 void parseExecuteCommand(char *command, unsigned long bloom_size, char *buffer, unsigned int buffer_size,
                          CountryMonitor **countries, LinkedList *viruses, MonitorInfo **monitors,
                          unsigned int num_countries, unsigned int active_monitors,
-                         unsigned int &accepted, unsigned int &rejected)
+                         unsigned int &accepted, unsigned int &rejected, FILE *request_log)
 {
     // Variables used for storing command parameters
     unsigned int citizen_id;
     char *country_name, *country_from, *country_to, *virus_name;
     Date date, start, end;
+    // The executed command (if any), for its latency to be recorded
+    int executed = -1;
+    unsigned long long start_micros = currentMicros();
 
     char *token = strtok(command, " ");
     if (token != NULL)
@@ -70,7 +77,8 @@ void parseExecuteCommand(char *command, unsigned long bloom_size, char *buffer,
             if (travelRequestParse(citizen_id, date, country_from, country_to, virus_name))
             {
                 travelRequest(citizen_id, date, country_from, country_to, virus_name, viruses, monitors, active_monitors,
-                              countries, num_countries, buffer, buffer_size, accepted, rejected);
+                              countries, num_countries, buffer, buffer_size, accepted, rejected, request_log);
+                executed = CMD_TRAVEL_REQUEST;
             }
             delete[] country_from;
             delete[] country_to;
@@ -81,6 +89,29 @@ void parseExecuteCommand(char *command, unsigned long bloom_size, char *buffer,
             if (travelStatsParse(virus_name, start, end, country_name))
             {
                 travelStats(virus_name, start, end, country_name, countries, num_countries);
+                executed = CMD_TRAVEL_STATS;
+            }
+            delete[] country_name;
+            delete[] virus_name;
+        }
+        else if (strcmp(token, "/populationStatus") == 0)
+        {
+            if (populationStatusParse(country_name, virus_name, start, end))
+            {
+                populationStatus(virus_name, start, end, country_name, monitors, active_monitors,
+                                 countries, num_countries, buffer, buffer_size);
+                executed = CMD_POPULATION_STATUS;
+            }
+            delete[] country_name;
+            delete[] virus_name;
+        }
+        else if (strcmp(token, "/popStatusByAge") == 0)
+        {
+            if (populationStatusParse(country_name, virus_name, start, end))
+            {
+                popStatusByAge(virus_name, start, end, country_name, monitors, active_monitors,
+                               countries, num_countries, buffer, buffer_size);
+                executed = CMD_POP_STATUS_BY_AGE;
             }
             delete[] country_name;
             delete[] virus_name;
@@ -89,7 +120,8 @@ void parseExecuteCommand(char *command, unsigned long bloom_size, char *buffer,
         {
             if (addVaccinationRecordsParse(country_name))
             {
-                addVaccinationRecords(country_name, countries, num_countries, viruses, buffer, buffer_size, bloom_size);
+                addVaccinationRecords(country_name, countries, num_countries, viruses, buffer, buffer_size);
+                executed = CMD_ADD_RECORDS;
             }
             delete[] country_name;
         }
@@ -98,6 +130,21 @@ void parseExecuteCommand(char *command, unsigned long bloom_size, char *buffer,
             if (searchVaccinationStatusParse(citizen_id))
             {
                 searchVaccinationStatus(citizen_id, monitors, active_monitors, buffer, buffer_size);
+                executed = CMD_SEARCH_STATUS;
+            }
+        }
+        else if (strcmp(token, "/stats") == 0)
+        {
+            if (noArgumentsParse())
+            {
+                runtimeStats(viruses, monitors, active_monitors, command_latencies, buffer, buffer_size);
+            }
+        }
+        else if (strcmp(token, "/bloomStats") == 0)
+        {
+            if (noArgumentsParse())
+            {
+                bloomStats(viruses, bloom_size);
             }
         }
         else
@@ -105,6 +152,10 @@ void parseExecuteCommand(char *command, unsigned long bloom_size, char *buffer,
             printf("Unknown command.\n");
         }
     }
+    if (executed != -1)
+    {
+        command_latencies[executed].add(currentMicros() - start_micros);
+    }
 }
 
 /**
@@ -150,6 +201,7 @@ int main(int argc, char const *argv[])
 
     unsigned int num_monitors, active_monitors, num_dirs, num_countries, buffer_size, cyclic_buffer_size, num_threads;
     unsigned long bloom_size;
+    int placement, membership;
     char *directory_path, **child_argv;
     MonitorInfo **monitors;
     CountryMonitor **countries;
@@ -157,19 +209,20 @@ int main(int argc, char const *argv[])
     struct dirent **directories;
     
     // Check given arguments and store them
-    if (!parentCheckParseArgs(argc, argv, directory_path, num_monitors, bloom_size, buffer_size, cyclic_buffer_size, num_threads))
+    if (!parentCheckParseArgs(argc, argv, directory_path, num_monitors, bloom_size, buffer_size, cyclic_buffer_size, num_threads,
+                              placement, membership))
     {
         delete[] directory_path;
         exit(EXIT_FAILURE);
     }
     // Assign country directories to child Monitors
-    if (!assignMonitorDirectories(directory_path, countries, monitors, num_monitors, directories, num_dirs))
+    if (!assignMonitorDirectories(directory_path, countries, monitors, num_monitors, directories, num_dirs, placement))
     {
         exit(EXIT_FAILURE);
     }
     num_countries = num_dirs - 2;   // num_dirs counts "." and ".." as well
 
-    buildBasicArgv(child_argv, num_threads, buffer_size, cyclic_buffer_size, bloom_size);
+    buildBasicArgv(child_argv, num_threads, buffer_size, cyclic_buffer_size, bloom_size, membership);
 
     // Create child Monitors
     createMonitors(monitors, num_monitors, active_monitors, child_argv);
@@ -182,14 +235,21 @@ int main(int argc, char const *argv[])
     // Receive and "merge" Monitor bloom filters
     receiveMonitorFilters(monitors, active_monitors, viruses, buffer, buffer_size, bloom_size);
 
+    // Replay the Travel Requests decided in previous executions, and keep appending the new ones
+    FILE *request_log = openRequestLog(REQUEST_LOG_PATH, countries, num_countries);
+
     char *line_buf;
     unsigned int accepted_requests = 0;
     unsigned int rejected_requests = 0;
     // Loop until SIGINT/SIGQUIT received or users types "/exit"
     printf("Now in command line mode.\n");
+    // The banner marks the end of the startup phase (timed by bench/startup_bench.sh), so flush it right away
+    fflush(stdout);
     while ( !terminate )
     {
         printf("------------------------------------------\n");
+        // Flush the output of the previous command, in case stdout is not a terminal (e.g. a pipe)
+        fflush(stdout);
         // Get user command
         line_buf = fgetline(stdin);
         if (line_buf == NULL)
@@ -199,7 +259,7 @@ int main(int argc, char const *argv[])
         if (sigchld_received > 0)
         // One or more child processes has died, so restore them
         {
-            checkAndRestoreChildren(monitors, active_monitors, buffer, buffer_size, bloom_size, viruses,
+            checkAndRestoreChildren(monitors, active_monitors, buffer, buffer_size, viruses,
                                     sigchld_received, child_argv);
         }
         if (strcmp(line_buf, "/exit") == 0)
@@ -211,7 +271,7 @@ int main(int argc, char const *argv[])
         }
         // Otherwise, try to parse the line into a command and execute it.
         parseExecuteCommand(line_buf, bloom_size, buffer, buffer_size, countries, viruses, monitors, num_countries, active_monitors,
-                            accepted_requests, rejected_requests);
+                            accepted_requests, rejected_requests, request_log);
         free(line_buf);
     }
 
@@ -219,6 +279,10 @@ int main(int argc, char const *argv[])
 
     terminateChildren(monitors, active_monitors, buffer, buffer_size);
     createLogFile(countries, num_countries, accepted_requests, rejected_requests);
+    if (request_log != NULL)
+    {
+        fclose(request_log);
+    }
 
     delete[] directory_path;
     delete[] buffer;
@@ -6,6 +6,7 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <cmath>
 #include <string>
 #include <sstream>
 
@@ -22,19 +23,73 @@
 #include <netinet/in.h>
 
 #include "../include/linked_list.hpp"
+#include "../include/hash_table.hpp"
 #include "../include/bloom_filter.hpp"
-#include "../include/rb_tree.hpp"
+#include "../include/scalable_bloom_filter.hpp"
+#include "../include/roaring_bitmap.hpp"
 #include "../include/utils.hpp"
 #include "parent_monitor_utils.hpp"
 #include "app_utils.hpp"
+#include "request_log.hpp"
 #include "../include/messaging.hpp"
 
+CachedVaccination::CachedVaccination(unsigned int id, const char *virus, const CountryMonitor *country,
+                                     const Date &vaccination_date):
+citizen_id(id), virus_name(virus), country_from(country), date(vaccination_date) { }
+
+/**
+ * Compares the given CachedVaccination "key" with a stored CachedVaccination
+ * (they are equal if they refer to the same citizen, virus & origin country).
+ */
+static int compareCachedVaccination(void *key, void *cached)
+{
+    CachedVaccination *a = static_cast<CachedVaccination*>(key);
+    CachedVaccination *b = static_cast<CachedVaccination*>(cached);
+    if (a->citizen_id != b->citizen_id) { return (a->citizen_id < b->citizen_id) ? -1 : 1; }
+    if (a->country_from != b->country_from) { return (a->country_from < b->country_from) ? -1 : 1; }
+    return strcmp(a->virus_name, b->virus_name);
+}
+
+static int cachedVaccinationHashObject(void *cached)
+{
+    return static_cast<CachedVaccination*>(cached)->citizen_id;
+}
+
 MonitorInfo::MonitorInfo(): socket_fd(-1), process_id(-1), ftok_arg(-1), io_fd(-1),
-subdirs(new LinkedList(delete_object_array<char>)) { }
+subdirs(new LinkedList(delete_object_array<char>)), assigned_bytes(0),
+vaccination_cache(new HashTable(VACCINATION_CACHE_BUCKETS, delete_object<CachedVaccination>, cachedVaccinationHashObject)),
+cached_vaccinations(0) { }
 
 MonitorInfo::~MonitorInfo()
 {
     delete subdirs;
+    delete vaccination_cache;
+}
+
+/**
+ * Removes all the cached vaccination dates sent by the Monitor. Called whenever the Monitor
+ * sends new filters, since its records (of any of its countries) may have changed.
+ */
+void MonitorInfo::clearVaccinationCache()
+{
+    delete this->vaccination_cache;
+    this->vaccination_cache = new HashTable(VACCINATION_CACHE_BUCKETS, delete_object<CachedVaccination>,
+                                            cachedVaccinationHashObject);
+    this->cached_vaccinations = 0;
+}
+
+/**
+ * Stores the given vaccination date sent by the Monitor in the cache. If the cache already has
+ * VACCINATION_CACHE_CAPACITY dates, it is cleared first, so that its size (and its chains) stay bounded.
+ */
+void MonitorInfo::cacheVaccination(CachedVaccination *cached)
+{
+    if (this->cached_vaccinations >= VACCINATION_CACHE_CAPACITY)
+    {
+        clearVaccinationCache();
+    }
+    this->vaccination_cache->insert(cached);
+    this->cached_vaccinations++;
 }
 
 /**
@@ -108,19 +163,17 @@ void MonitorInfo::terminateConnection()
 }
 
 VirusRequests::VirusRequests(const char *name):
-virus_name(copyString(name)), requests_tree(new RedBlackTree(compareTravelRequests)) { }
+virus_name(copyString(name)), accepted(new DateCounter()), rejected(new DateCounter()) { }
 
 VirusRequests::~VirusRequests()
 {
     delete[] virus_name;
-    // The Tree destructor does not delete node data when deleting the nodes,
-    // but the clear method does.
-    requests_tree->clear(delete_object<TravelRequest>);
-    delete requests_tree;
+    delete accepted;
+    delete rejected;
 }
 
 CountryMonitor::CountryMonitor(const char *name, MonitorInfo *monitor_info):
-country_name(copyString(name)), monitor(monitor_info), virus_requests(new LinkedList(delete_object<VirusRequests>)) { }
+country_name(copyString(name)), monitor(monitor_info), bytes(0), virus_requests(new LinkedList(delete_object<VirusRequests>)) { }
 
 CountryMonitor::~CountryMonitor()
 {
@@ -128,30 +181,118 @@ CountryMonitor::~CountryMonitor()
     delete[] country_name;
 }
 
-TravelRequest::TravelRequest(Date &request_date, bool is_accepted):
-date(request_date), accepted(is_accepted) { }
+PopulationStats::PopulationStats(): reported(false)
+{
+    for (unsigned int i = 0; i < AGE_GROUPS; i++)
+    {
+        population[i] = vaccinated[i] = 0;
+    }
+}
 
-TravelRequest::~TravelRequest() { }
+MonitorStats::MonitorStats(): records_parsed(0), records_rejected(0)
+{
+    for (unsigned int i = 0; i < TRAFFIC_ROUTINES; i++)
+    {
+        sent_calls[i] = sent_bytes[i] = received_calls[i] = received_bytes[i] = 0;
+    }
+}
 
-VirusFilter::VirusFilter(const char *name, unsigned long size): virus_name(copyString(name)), filter(new BloomFilter(size)) { }
+VirusFilter::VirusFilter(const char *name, ScalableBloomFilter *virus_filter, RoaringBitmap *virus_ids):
+virus_name(copyString(name)), filter(virus_filter), ids(virus_ids) { }
 
 VirusFilter::~VirusFilter()
 {
     delete[] virus_name;
     delete filter;
+    delete ids;
+}
+
+VaccinatedCount::VaccinatedCount(MonitorInfo *sender, char *name, unsigned long vaccinated):
+monitor(sender), virus_name(name), count(vaccinated), total(vaccinated) { }
+
+VaccinatedCount::~VaccinatedCount()
+{
+    free(virus_name);
+}
+
+/**
+ * Returns the total size (in bytes) of the regular files in the specified directory.
+ */
+unsigned long long directoryBytes(const char *path)
+{
+    unsigned long long total = 0;
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+    {
+        return 0;
+    }
+    struct dirent *entry;
+    struct stat file_stat;
+    while ( (entry = readdir(dir)) != NULL )
+    {
+        std::string file_path(path);
+        file_path.append("/");
+        file_path.append(entry->d_name);
+        if (stat(file_path.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode))
+        {
+            total += file_stat.st_size;
+        }
+    }
+    closedir(dir);
+    return total;
 }
 
 /**
- * @brief Assigns the Country Directories to the Monitors (Round-Robin style).
+ * Used by qsort to sort CountryMonitors by descending bytes (and then by name).
+ */
+static int compareCountryBytes(const void *a, const void *b)
+{
+    const CountryMonitor *c1 = *static_cast<CountryMonitor* const*>(a);
+    const CountryMonitor *c2 = *static_cast<CountryMonitor* const*>(b);
+    if (c1->bytes != c2->bytes)
+    {
+        return (c1->bytes > c2->bytes) ? -1 : 1;
+    }
+    return strcmp(c1->country_name, c2->country_name);
+}
+
+/**
+ * Returns the index of the Monitor with the least assigned bytes (and then the least directories).
+ * Monitors that have not been created yet (NULL) have no bytes & directories.
+ */
+static unsigned int leastLoadedMonitor(MonitorInfo **monitors, unsigned int num_monitors)
+{
+    unsigned int least = 0;
+    unsigned long long least_bytes = 0, least_dirs = 0;
+    for (unsigned int i = 0; i < num_monitors; i++)
+    {
+        unsigned long long bytes = (monitors[i] == NULL) ? 0 : monitors[i]->assigned_bytes;
+        unsigned long long dirs = (monitors[i] == NULL) ? 0 : monitors[i]->subdirs->getNumElements();
+        if (i == 0 || bytes < least_bytes || (bytes == least_bytes && dirs < least_dirs))
+        {
+            least = i;
+            least_bytes = bytes;
+            least_dirs = dirs;
+        }
+    }
+    return least;
+}
+
+/**
+ * @brief Assigns the Country Directories to the Monitors.
  * 
  * @param path The path of the Directory that contains the Country Directories.
  * @param countries An array of pointers to CountryMonitors. When this routine returns,
- * it will contain 1 CountryMonitor for each country that had a directory.
+ * it will contain 1 CountryMonitor for each country that had a directory (sorted by name).
  * @param monitors An array of pointers to MonitorInfos. When this routine returns, it
  * will contain 1 MonitorInfo for each Monitor to be created.
+ * @param placement PLACEMENT_ROUND_ROBIN to assign the directories in Round-Robin style (by name),
+ * or PLACEMENT_SIZE to assign the largest directories first, each one to the Monitor with the
+ * least assigned bytes so far (Longest Processing Time first).
  */
 bool assignMonitorDirectories(char *path, CountryMonitor **&countries, MonitorInfo **&monitors,
-                              unsigned int num_monitors, struct dirent **&directories, unsigned int &num_dirs)
+                              unsigned int num_monitors, struct dirent **&directories, unsigned int &num_dirs,
+                              int placement)
 {
     unsigned int i;
     directories = NULL;
@@ -165,10 +306,26 @@ bool assignMonitorDirectories(char *path, CountryMonitor **&countries, MonitorIn
     }
 
     // Create the Countries array
-    countries = new CountryMonitor*[num_dirs - 2];
-    for (i = 0; i < num_dirs - 2; i++)
+    // Skip directories[0] and directories[1] ("." and ".." respectively)
+    unsigned int num_countries = num_dirs - 2;
+    countries = new CountryMonitor*[num_countries];
+    // The order in which the Countries will be assigned
+    CountryMonitor **order = new CountryMonitor*[num_countries];
+    for (i = 0; i < num_countries; i++)
+    {
+        countries[i] = new CountryMonitor(directories[i + 2]->d_name, NULL);
+        order[i] = countries[i];
+        if (placement == PLACEMENT_SIZE)
+        {
+            std::string directory_path(path);
+            directory_path.append("/");
+            directory_path.append(countries[i]->country_name);
+            countries[i]->bytes = directoryBytes(directory_path.c_str());
+        }
+    }
+    if (placement == PLACEMENT_SIZE)
     {
-        countries[i] = NULL;
+        qsort(order, num_countries, sizeof(CountryMonitor*), compareCountryBytes);
     }
     // Create the Monitors array. If a Monitor is not created,
     // the corresponding element will be NULL.
@@ -180,9 +337,12 @@ bool assignMonitorDirectories(char *path, CountryMonitor **&countries, MonitorIn
 
     i = 0;  // This will be used as monitor counter
 
-    // Skip directories[0] and directories[1] ("." and ".." respectively)
-    for (unsigned int j = 2; j < num_dirs; j++)
+    for (unsigned int j = 0; j < num_countries; j++)
     {
+        if (placement == PLACEMENT_SIZE)
+        {
+            i = leastLoadedMonitor(monitors, num_monitors);
+        }
         if (monitors[i] == NULL)
         // This monitor has not been created yet
         {
@@ -191,15 +351,17 @@ bool assignMonitorDirectories(char *path, CountryMonitor **&countries, MonitorIn
         // Create the full path of the current Country Directory
         std::string directory_path(path);
         directory_path.append("/");
-        directory_path.append(directories[j]->d_name);
+        directory_path.append(order[j]->country_name);
         // Story the Directory path in the MonitorInfo
         monitors[i]->subdirs->append(copyString(directory_path.c_str()));
-        // Create the CountryMonitor for this Country
-        countries[j - 2] = new CountryMonitor(directories[j]->d_name, monitors[i]);
+        monitors[i]->assigned_bytes += order[j]->bytes;
+        // Assign the Country to the Monitor
+        order[j]->monitor = monitors[i];
         // Go to the next monitor in Round-Robin style
         i++;
         i = i % num_monitors;
     }
+    delete[] order;
 
     return true;
 }
@@ -211,10 +373,10 @@ bool assignMonitorDirectories(char *path, CountryMonitor **&countries, MonitorIn
  * @param argv The argv skeleton will be stored here.
  */
 void buildBasicArgv(char **&argv, unsigned int num_threads, unsigned int buffer_size,
-                    unsigned int cyclic_buffer_size, unsigned long bloom_size)
+                    unsigned int cyclic_buffer_size, unsigned long bloom_size, int membership)
 {
-    // We need at least 12 elements (11 parameters + NULL)
-    argv = static_cast<char**>(malloc(sizeof(char*) * 12));
+    // We need at least 14 elements (13 parameters + NULL)
+    argv = static_cast<char**>(malloc(sizeof(char*) * 14));
     if (argv == NULL)
     {
         fprintf(stderr, "child argv malloc failed");
@@ -232,6 +394,8 @@ void buildBasicArgv(char **&argv, unsigned int num_threads, unsigned int buffer_
     argv[8] = copyString(std::to_string(cyclic_buffer_size).c_str());
     argv[9] = copyString("-s");
     argv[10] = copyString(std::to_string(bloom_size).c_str());
+    argv[11] = copyString("-f");
+    argv[12] = copyString((membership == MEMBERSHIP_EXACT) ? "exact" : "bloom");
     // One more element will be set to NULL by buildChildArgv
 }
 
@@ -245,7 +409,7 @@ void deleteBasicArgv(char **argv)
     {
         delete[] argv[i];
     } 
-    while (++i < 11);
+    while (++i < 13);
     free(argv);
 }
 
@@ -256,9 +420,9 @@ void buildChildArgv(char **&argv, MonitorInfo *monitor, uint16_t port)
 {
     // Store port number
     argv[2] = copyString(std::to_string(port).c_str());
-    int argc = 12 + monitor->subdirs->getNumElements();
+    int argc = 14 + monitor->subdirs->getNumElements();
 
-    if (argc > 12)
+    if (argc > 14)
     // There are directory paths to be passed to the Monitor
     {
         // Increase argv size by the number of paths
@@ -270,7 +434,7 @@ void buildChildArgv(char **&argv, MonitorInfo *monitor, uint16_t port)
         }
         argv = static_cast<char**>(realloc_res);
         LinkedList::ListIterator itr = monitor->subdirs->listHead();
-        for (int i = 11; i < argc; i++)
+        for (int i = 13; i < argc; i++)
         // Add all the directory paths assigned to this Monitor
         {
             argv[i] = static_cast<char*>(itr.getData());
@@ -328,13 +492,206 @@ void createMonitors(MonitorInfo **monitors, unsigned int num_monitors, unsigned
     active_monitors = i;
 }
 
+/**
+ * Returns the given estimated number of citizens of a filter as an integer
+ * (MAX_BLOOM_SIZE * 8 if it is too large, e.g. infinite because the filter is full).
+ */
+static unsigned long estimatedCitizens(double items)
+{
+    return (items < MAX_BLOOM_SIZE * 8) ? (unsigned long)ceil(items) : MAX_BLOOM_SIZE * 8;
+}
+
+/**
+ * Sends the size & number of Hash Functions of the first stage of the given filter to the given Monitor,
+ * along with the specified number of citizens in it (see VirusRecords::rebuildFilter).
+ * If filter is NULL, zeros are sent, so that the Monitor sizes its filter by itself.
+ */
+static void sendFilterParameters(MonitorInfo *monitor, const ScalableBloomFilter *filter, unsigned long shared_items,
+                                 char *buffer, unsigned int buffer_size)
+{
+    sendInt(monitor->io_fd, (filter == NULL) ? 0 : filter->getStage(0)->numBytes, buffer, buffer_size);
+    sendInt(monitor->io_fd, (filter == NULL) ? 0 : filter->getStage(0)->numHashes, buffer, buffer_size);
+    sendInt(monitor->io_fd, (filter == NULL) ? 0 : shared_items, buffer, buffer_size);
+}
+
+/**
+ * Requests the Bloom Filter of the specified virus from the given Monitor, rebuilt with the size
+ * & number of Hash Functions of the first stage of the stored filter (the Monitor keeps them from now on),
+ * and merges it in the stored filter. The Monitor is also informed of the specified number of citizens
+ * in the stored filter (see VirusRecords::rebuildFilter). An error is reported if the received filter cannot be merged
+ * either (e.g. it was not valid).
+ */
+static void requestBloomFilter(MonitorInfo *monitor, VirusFilter *virus, unsigned long shared_items,
+                               char *buffer, unsigned int buffer_size)
+{
+    sendMessageType(monitor->io_fd, BLOOM_FILTER_REQUEST, buffer, buffer_size);
+    sendString(monitor->io_fd, virus->virus_name, buffer, buffer_size);
+    sendFilterParameters(monitor, virus->filter, shared_items, buffer, buffer_size);
+    kill(monitor->process_id, SIGUSR2);
+    if (!updateBloomFilter(monitor->io_fd, virus->filter, buffer, buffer_size))
+    // The stored filter is not replaced, since it also has the citizens of the other Monitors
+    {
+        fprintf(stderr, "Failed to merge the requested Bloom Filter for %s\n", virus->virus_name);
+    }
+}
+
+/**
+ * Receives the number of vaccinated citizens of each virus, sent by the given Monitor (after VACCINATED_COUNTS),
+ * and appends them in the given LinkedList of VaccinatedCount objects (in the order they were sent).
+ */
+static void receiveVaccinatedCounts(MonitorInfo *monitor, LinkedList *counts, char *buffer, unsigned int buffer_size)
+{
+    unsigned int num_viruses;
+    receiveInt(monitor->io_fd, num_viruses, buffer, buffer_size);
+    for (unsigned int j = 0; j < num_viruses; j++)
+    {
+        char *virus_name;
+        unsigned int count;
+        receiveString(monitor->io_fd, virus_name, buffer, buffer_size);
+        receiveInt(monitor->io_fd, count, buffer, buffer_size);
+        counts->append(new VaccinatedCount(monitor, virus_name, count));
+    }
+}
+
+/**
+ * Receives the vaccinated citizen counts of the given (restored) Monitor, and answers with the parameters
+ * of the stored filter of each virus, so that the filters the Monitor builds can be merged in the stored ones.
+ * The Monitor sizes the filters of unknown viruses by itself (they are stored as they are sent).
+ */
+static void sendStoredFilterParameters(MonitorInfo *monitor, LinkedList *viruses, char *buffer, unsigned int buffer_size)
+{
+    LinkedList counts(delete_object<VaccinatedCount>);
+    receiveVaccinatedCounts(monitor, &counts, buffer, buffer_size);
+    for (LinkedList::ListIterator itr = counts.listHead(); !itr.isNull(); itr.forward())
+    {
+        VaccinatedCount *count = static_cast<VaccinatedCount*>(itr.getData());
+        VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(count->virus_name, compareNameVirusFilter));
+        if (virus == NULL || virus->filter == NULL)
+        {
+            sendFilterParameters(monitor, NULL, 0, buffer, buffer_size);
+        }
+        else
+        {
+            sendFilterParameters(monitor, virus->filter, estimatedCitizens(virus->filter->estimatedItems()),
+                                 buffer, buffer_size);
+        }
+    }
+}
+
+/**
+ * Returns the offset of the ID's of the given Monitor in the vaccinated ID bitmaps of the Parent.
+ * Each Monitor has its own range of 2^ID_BITS values in the bitmaps, so that the citizens of a country
+ * are only found present if they are vaccinated according to the Monitor of that country.
+ */
+static uint32_t idBitmapOffset(const MonitorInfo *monitor)
+{
+    return (uint32_t)(monitor->ftok_arg - 1) << ID_BITS;
+}
+
+/**
+ * Receives the (whole or changed) vaccinated ID bitmaps sent by the given Monitor in MEMBERSHIP_EXACT mode,
+ * and adds their ID's (in the range of the Monitor, see idBitmapOffset) in the stored ones.
+ * A new VirusFilter is stored for every unknown virus.
+ */
+static void receiveIdBitmaps(MonitorInfo *monitor, LinkedList *viruses, char *buffer, unsigned int buffer_size)
+{
+    unsigned int num_bitmaps;
+    // Receive the number of sent bitmaps
+    receiveInt(monitor->io_fd, num_bitmaps, buffer, buffer_size);
+    for (unsigned int j = 0; j < num_bitmaps; j++)
+    {
+        char *virus_name;
+        // Receive the name of the virus related with this bitmap
+        receiveString(monitor->io_fd, virus_name, buffer, buffer_size);
+        VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(virus_name, compareNameVirusFilter));
+        if (virus == NULL)
+        // If a new virus was detected, store an empty bitmap for it
+        {
+            virus = new VirusFilter(virus_name, NULL, new RoaringBitmap());
+            viruses->append(virus);
+        }
+        if (!updateIdBitmap(monitor->io_fd, virus->ids, idBitmapOffset(monitor), buffer, buffer_size))
+        {
+            fprintf(stderr, "Received invalid ID bitmap for %s\n", virus_name);
+        }
+        free(virus_name);
+    }
+}
+
+/**
+ * Receives the (whole or changed) Bloom Filters sent by the given Monitor, and merges them in the stored ones.
+ * A new VirusFilter is stored for every unknown virus, with the filter exactly as it was sent.
+ * Filters that cannot be merged (i.e. with stages of different size or Hash Functions) are requested again,
+ * with the parameters of the stored filters, after all the sent filters have been received.
+ * A restored Monitor sends its vaccinated citizen counts first (see sendStoredFilterParameters).
+ * In MEMBERSHIP_EXACT mode, vaccinated ID bitmaps are received instead (see receiveIdBitmaps).
+ */
+static void receiveBloomFilters(MonitorInfo *monitor, LinkedList *viruses, char *buffer, unsigned int buffer_size)
+{
+    char filters_type;
+    receiveMessageType(monitor->io_fd, filters_type, buffer, buffer_size);
+    if (filters_type == VACCINATED_COUNTS)
+    // A restored Monitor asks for the parameters of its filters before building them
+    {
+        sendStoredFilterParameters(monitor, viruses, buffer, buffer_size);
+        receiveMessageType(monitor->io_fd, filters_type, buffer, buffer_size);
+    }
+    if (filters_type == ID_BITMAPS)
+    {
+        receiveIdBitmaps(monitor, viruses, buffer, buffer_size);
+        return;
+    }
+    LinkedList incompatible(NULL);
+    unsigned int num_filters;
+    // Receive the number of sent Bloom Filters
+    receiveInt(monitor->io_fd, num_filters, buffer, buffer_size);
+    for (unsigned int j = 0; j < num_filters; j++)
+    {
+        char *virus_name;
+        // Receive the name of the virus related with this Bloom Filter
+        receiveString(monitor->io_fd, virus_name, buffer, buffer_size);
+        VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(virus_name, compareNameVirusFilter));
+        if (virus == NULL)
+        // If a new virus was detected, store the sent Bloom Filter for it
+        {
+            ScalableBloomFilter *filter = receiveBloomFilter(monitor->io_fd, buffer, buffer_size);
+            if (filter != NULL)
+            {
+                viruses->append(new VirusFilter(virus_name, filter));
+            }
+            else
+            {
+                fprintf(stderr, "Received invalid Bloom Filter for %s\n", virus_name);
+            }
+        }
+        else if (!updateBloomFilter(monitor->io_fd, virus->filter, buffer, buffer_size))
+        // The sent filter could not be merged in the stored one
+        {
+            incompatible.append(virus);
+        }
+        free(virus_name);
+    }
+    for (LinkedList::ListIterator itr = incompatible.listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusFilter *virus = static_cast<VirusFilter*>(itr.getData());
+        requestBloomFilter(monitor, virus, estimatedCitizens(virus->filter->estimatedItems()), buffer, buffer_size);
+    }
+}
+
 /**
  * Replaces a dead child Monitor with a new one.
  */
-void restoreChild(MonitorInfo *monitor, char *buffer, unsigned int buffer_size, unsigned long int bloom_size,
+void restoreChild(MonitorInfo *monitor, char *buffer, unsigned int buffer_size,
                   LinkedList *viruses, char **child_argv)
 {
     uint16_t port;
+    // The new Monitor is assigned the same directories (so that it can use the snapshot of the dead one,
+    // while the rest of the Monitors are not affected), but their current size is stored.
+    monitor->assigned_bytes = 0;
+    for (LinkedList::ListIterator itr = monitor->subdirs->listHead(); !itr.isNull(); itr.forward())
+    {
+        monitor->assigned_bytes += directoryBytes(static_cast<char*>(itr.getData()));
+    }
     // Close existing socket and create a new one
     monitor->terminateConnection();
     if ( !monitor->createSocket(port) )
@@ -364,22 +721,11 @@ void restoreChild(MonitorInfo *monitor, char *buffer, unsigned int buffer_size,
 
             // Send int to be given to ftok
             sendInt(monitor->io_fd, monitor->ftok_arg, buffer, buffer_size);
-            // Receive Bloom Filters
-            unsigned int num_filters;
-            receiveInt(monitor->io_fd, num_filters, buffer, buffer_size);
-            for (unsigned int j = 0; j < num_filters; j++)
-            {
-                char *virus_name;
-                receiveString(monitor->io_fd, virus_name, buffer, buffer_size);
-                VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(virus_name, compareNameVirusFilter));
-                if (virus == NULL)
-                {
-                    viruses->append(new VirusFilter(virus_name, bloom_size));
-                    virus = static_cast<VirusFilter*>(viruses->getLast());
-                }
-                free(virus_name);
-                updateBloomFilter(monitor->io_fd, virus->filter, buffer, buffer_size);
-            }
+            // Inform the Monitor that it replaces a dead one, so it may load its snapshot
+            sendMessageType(monitor->io_fd, MONITOR_RESTORE, buffer, buffer_size);
+            // Receive Bloom Filters (the cached answers of the dead Monitor are discarded)
+            monitor->clearVaccinationCache();
+            receiveBloomFilters(monitor, viruses, buffer, buffer_size);
     }
 }
 
@@ -387,7 +733,7 @@ void restoreChild(MonitorInfo *monitor, char *buffer, unsigned int buffer_size,
  * Restores any dead child Monitor processes.
  */
 void checkAndRestoreChildren(MonitorInfo **monitors, unsigned int num_monitors, char *buffer, unsigned int buffer_size,
-                             unsigned long int bloom_size, LinkedList *viruses, int &sigchld_counter, char **child_argv)
+                             LinkedList *viruses, int &sigchld_counter, char **child_argv)
 {
     int wait_pid;
     for(unsigned int i = 0; i < num_monitors; i++)
@@ -397,7 +743,7 @@ void checkAndRestoreChildren(MonitorInfo **monitors, unsigned int num_monitors,
         if(wait_pid > 0)
         // It is not, so restore it.
         {
-            restoreChild(monitors[i], buffer, buffer_size, bloom_size, viruses, child_argv);
+            restoreChild(monitors[i], buffer, buffer_size, viruses, child_argv);
             sigchld_counter--;
         }
     }
@@ -414,13 +760,65 @@ void sendMonitorData(MonitorInfo **monitors, unsigned int num_monitors, char *bu
     {
         monitors[i]->ftok_arg = ftok_id;
         sendInt(monitors[i]->io_fd, ftok_id, buffer, buffer_size);
+        // Inform the Monitor that it must scan all the files
+        sendMessageType(monitors[i]->io_fd, MONITOR_START, buffer, buffer_size);
         ftok_id++;
     }
 }
 
+/**
+ * Creates a new VirusFilter for each virus in the given vaccinated citizen counts (received from all the Monitors
+ * on startup), sized for the total count of all the Monitors (see BloomFilter::chooseParameters), up to max_bytes.
+ * The parameters of each filter are sent to the Monitors, which build their filters with them, so that all the
+ * filters the Monitors send can be merged in the new ones.
+ */
+static void createVirusFilters(LinkedList *counts, LinkedList *viruses, unsigned long max_bytes,
+                               char *buffer, unsigned int buffer_size)
+{
+    for (LinkedList::ListIterator itr = counts->listHead(); !itr.isNull(); itr.forward())
+    {
+        VaccinatedCount *first = static_cast<VaccinatedCount*>(itr.getData());
+        if (viruses->getElement(first->virus_name, compareNameVirusFilter) != NULL) { continue; }    // Already created
+
+        // Sum the counts of all the Monitors for this virus
+        unsigned long total = 0;
+        for (LinkedList::ListIterator other = itr; !other.isNull(); other.forward())
+        {
+            VaccinatedCount *same_virus = static_cast<VaccinatedCount*>(other.getData());
+            if (strcmp(same_virus->virus_name, first->virus_name) == 0)
+            {
+                total += same_virus->count;
+            }
+        }
+        for (LinkedList::ListIterator other = itr; !other.isNull(); other.forward())
+        {
+            VaccinatedCount *same_virus = static_cast<VaccinatedCount*>(other.getData());
+            if (strcmp(same_virus->virus_name, first->virus_name) == 0)
+            {
+                same_virus->total = total;
+            }
+        }
+        unsigned long filter_bytes;
+        unsigned int num_hashes;
+        BloomFilter::chooseParameters(total, max_bytes, filter_bytes, num_hashes);
+        viruses->append(new VirusFilter(first->virus_name, new ScalableBloomFilter(filter_bytes, num_hashes)));
+    }
+    // Answer each Monitor with the parameters of its viruses, in the order it sent their counts
+    for (LinkedList::ListIterator itr = counts->listHead(); !itr.isNull(); itr.forward())
+    {
+        VaccinatedCount *count = static_cast<VaccinatedCount*>(itr.getData());
+        VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(count->virus_name, compareNameVirusFilter));
+        sendFilterParameters(count->monitor, virus->filter, count->total, buffer, buffer_size);
+    }
+}
+
 /**
  * Receives the Bloom Filters of all child Monitors.
- * The filters are stored in the given LinkedList of VirusFilter objects.
+ * The Monitors first send the number of vaccinated citizens of each virus (gathered using select()),
+ * and the filter of each virus is created for the total count (see createVirusFilters). Then the filters
+ * of the Monitors, built with the same parameters, are received and merged in the given LinkedList of VirusFilter objects.
+ * Each filter will have up to bloom_size bytes.
+ * In MEMBERSHIP_EXACT mode, the vaccinated ID bitmaps of the Monitors are received and added in the VirusFilters directly.
  */
 void receiveMonitorFilters(MonitorInfo **monitors, unsigned int num_monitors, LinkedList *viruses,
                            char *buffer, unsigned int buffer_size, unsigned long int bloom_size)
@@ -434,9 +832,12 @@ void receiveMonitorFilters(MonitorInfo **monitors, unsigned int num_monitors, Li
 
     unsigned int done_monitors = 0;
     int max_fd = -1;
+    LinkedList counts(delete_object<VaccinatedCount>);
+    bool *sent_counts = new bool[num_monitors];
     // Open read pipe for each child Monitor
     for (unsigned int i = 0; i < num_monitors; i++)
     {
+        sent_counts[i] = false;
         // Add each FD to the set and find max FD to pass to select()
         FD_SET(monitors[i]->io_fd, &fdset);
         if (max_fd < monitors[i]->io_fd)
@@ -445,7 +846,7 @@ void receiveMonitorFilters(MonitorInfo **monitors, unsigned int num_monitors, Li
         }
     }
 
-    // Keep looping until Bloom Filters have been received for all children
+    // Keep looping until the counts (or ID bitmaps) have been received for all children
     while (done_monitors != num_monitors)
     {
         int ready_fds;
@@ -464,26 +865,18 @@ void receiveMonitorFilters(MonitorInfo **monitors, unsigned int num_monitors, Li
                 if (FD_ISSET(monitors[i]->io_fd, &fdset))
                 // The read FD of this monitor is ready
                 {
-                    // Receive the Bloom Filters sent by this Monitor
-                    unsigned int num_filters;
-                    // Receive number of sent Bloom Filters
-                    receiveInt(monitors[i]->io_fd, num_filters, buffer, buffer_size);
-                    for (unsigned int j = 0; j < num_filters; j++)
+                    char msg_type;
+                    receiveMessageType(monitors[i]->io_fd, msg_type, buffer, buffer_size);
+                    if (msg_type == ID_BITMAPS)
+                    // The exact vaccinated ID's are sent instead of Bloom Filters, so just add them in the stored ones
                     {
-                        char *virus_name;
-                        // Receive the name of the virus related with this Bloom Filter
-                        receiveString(monitors[i]->io_fd, virus_name, buffer, buffer_size);
-                        // Try to find the VirusFilter for this virus
-                        VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(virus_name, compareNameVirusFilter));
-                        if (virus == NULL)
-                        // No VirusFilter found for this virus, so create one now.
-                        {
-                            viruses->append(new VirusFilter(virus_name, bloom_size));
-                            virus = static_cast<VirusFilter*>(viruses->getLast());
-                        }
-                        free(virus_name);
-                        // Receive the BloomFilter and update the stored one.
-                        updateBloomFilter(monitors[i]->io_fd, virus->filter, buffer, buffer_size);
+                        receiveIdBitmaps(monitors[i], viruses, buffer, buffer_size);
+                    }
+                    else
+                    // Store the counts until the counts of all the Monitors have been received
+                    {
+                        receiveVaccinatedCounts(monitors[i], &counts, buffer, buffer_size);
+                        sent_counts[i] = true;
                     }
                     done_monitors++;
                 }
@@ -496,13 +889,23 @@ void receiveMonitorFilters(MonitorInfo **monitors, unsigned int num_monitors, Li
             FD_SET(monitors[i]->io_fd, &fdset);
         }
     }
+    // Send the parameters to all the Monitors before receiving any filter, so they build their filters in parallel
+    createVirusFilters(&counts, viruses, bloom_size, buffer, buffer_size);
+    for (unsigned int i = 0; i < num_monitors; i++)
+    {
+        if (sent_counts[i])
+        {
+            receiveBloomFilters(monitors[i], viruses, buffer, buffer_size);
+        }
+    }
+    delete[] sent_counts;
 }
 
 /**
  * Executes the /addVaccinationRecords command, for the specified Country.
  */
 void addVaccinationRecords(const char *country_name, CountryMonitor **countries, unsigned int num_countries,
-                           LinkedList *viruses, char *buffer, unsigned int buffer_size, unsigned long int bloom_size)
+                           LinkedList *viruses, char *buffer, unsigned int buffer_size)
 {
     // Iterate over the countries
     for (unsigned int i = 0; i < num_countries; i++)
@@ -512,26 +915,10 @@ void addVaccinationRecords(const char *country_name, CountryMonitor **countries,
         {
             // Send SIGUSR1 to child
             kill(countries[i]->monitor->process_id, SIGUSR1);
-            unsigned int num_filters;
-            // Receive the number of bloom filters that were sent
-            receiveInt(countries[i]->monitor->io_fd, num_filters, buffer, buffer_size);
-            // Receive the bloom filters
-            for (unsigned int j = 0; j < num_filters; j++)
-            {
-                char *virus_name;
-                // Get the name of the virus related to this bloom filter
-                receiveString(countries[i]->monitor->io_fd, virus_name, buffer, buffer_size);
-                VirusFilter *virus = static_cast<VirusFilter*>(viruses->getElement(virus_name, compareNameVirusFilter));
-                if (virus == NULL)
-                // If a new virus was detected, store a new Bloom Filter for it
-                {
-                    viruses->append(new VirusFilter(virus_name, bloom_size));
-                    virus = static_cast<VirusFilter*>(viruses->getLast());
-                }
-                free(virus_name);
-                // Receive the new Bloom Filter and update the present one
-                updateBloomFilter(countries[i]->monitor->io_fd, virus->filter, buffer, buffer_size);
-            }
+            // Receive the changes in the bloom filters (only the changed filters are sent) and update the present ones
+            receiveBloomFilters(countries[i]->monitor, viruses, buffer, buffer_size);
+            // The records of the Monitor may have changed, so its cached answers are discarded
+            countries[i]->monitor->clearVaccinationCache();
             // Done
             printf("Records updated successfully.\n");
             return;
@@ -619,7 +1006,8 @@ void searchVaccinationStatus(unsigned int citizen_id, MonitorInfo **monitors, un
 void travelRequest(unsigned int citizen_id, Date &date, char *country_from, char *country_to, char *virus_name,
                    LinkedList *viruses, MonitorInfo **monitors, unsigned int active_monitors,
                    CountryMonitor **countries, unsigned int num_countries,
-                   char *buffer, unsigned int buffer_size, unsigned int &accepted_requests, unsigned int &rejected_requests)
+                   char *buffer, unsigned int buffer_size, unsigned int &accepted_requests, unsigned int &rejected_requests,
+                   FILE *request_log)
 {
     // Get the Bloom Filter for the specified virus
     VirusFilter *target_virus = static_cast<VirusFilter*>(viruses->getElement(virus_name, compareNameVirusFilter));
@@ -668,41 +1056,69 @@ void travelRequest(unsigned int citizen_id, Date &date, char *country_from, char
 
             // This indicates whether the request is rejected or accepted
             bool accepted = false;
-            if (target_virus->filter->isPresent(char_id))
+            target_virus->lookups.add();
+            // In MEMBERSHIP_EXACT mode, the citizen ID is present only if the Monitor of the country has vaccinated the citizen
+            bool maybe_present = (target_virus->ids != NULL)
+                                 ? target_virus->ids->contains(idBitmapOffset(target_country_from->monitor) + citizen_id)
+                                 : target_virus->filter->isPresent(char_id);
+            MonitorInfo *monitor = target_country_from->monitor;
+            CachedVaccination key(citizen_id, target_virus->virus_name, target_country_from, Date());
+            CachedVaccination *cached = NULL;
+            if (maybe_present)
+            {
+                cached = static_cast<CachedVaccination*>(monitor->vaccination_cache->getElement(citizen_id, &key,
+                                                                                                compareCachedVaccination));
+            }
+            if (cached != NULL)
+            // The Monitor has already sent the vaccination date of the citizen, so decide locally
+            {
+                Date date6monthsPrior;
+                date6monthsPrior.set6monthsPrior(date);
+                accepted = cached->date.isBetween(date6monthsPrior, date);
+                printf("%s", accepted ? TRAVEL_ACCEPTED_ANSWER : TRAVEL_VACCINATION_NEEDED_ANSWER);
+                target_virus->positives.add();
+                target_virus->hits.add();
+                target_virus->cached.add();
+            }
+            else if (maybe_present)
             // The citizen ID is marked as "maybe present" in the Bloom Filter
             {
                 char ans_type;
                 char *answer;
                 // Send Request type and required information
-                sendMessageType(target_country_from->monitor->io_fd, TRAVEL_REQUEST, buffer, buffer_size);
-                sendInt(target_country_from->monitor->io_fd, citizen_id, buffer, buffer_size);
-                sendDate(target_country_from->monitor->io_fd, date, buffer, buffer_size);
-                sendString(target_country_from->monitor->io_fd, virus_name, buffer, buffer_size);
+                sendMessageType(monitor->io_fd, TRAVEL_REQUEST, buffer, buffer_size);
+                sendInt(monitor->io_fd, citizen_id, buffer, buffer_size);
+                sendDate(monitor->io_fd, date, buffer, buffer_size);
+                sendString(monitor->io_fd, virus_name, buffer, buffer_size);
                 // Notify the Monitor process
-                kill(target_country_from->monitor->process_id, SIGUSR2);
+                kill(monitor->process_id, SIGUSR2);
                 
                 // Receive Monitor answer
-                receiveMessageType(target_country_from->monitor->io_fd, ans_type, buffer, buffer_size);
-                receiveString(target_country_from->monitor->io_fd, answer, buffer, buffer_size);
+                receiveMessageType(monitor->io_fd, ans_type, buffer, buffer_size);
+                receiveString(monitor->io_fd, answer, buffer, buffer_size);
                 printf("%s", answer);
                 free(answer);
                 accepted = (ans_type == TRAVEL_REQUEST_ACCEPTED);
+                target_virus->positives.add();
+                if (ans_type != TRAVEL_REQUEST_NOT_VACCINATED)
+                // A vaccination record was found, so its date is sent as well
+                {
+                    target_virus->hits.add();
+                    receiveDate(monitor->io_fd, key.date, buffer, buffer_size);
+                    monitor->cacheVaccination(new CachedVaccination(citizen_id, target_virus->virus_name,
+                                                                    target_country_from, key.date));
+                }
             }
             else
             {
                 printf("REQUEST REJECTED - YOU ARE NOT VACCINATED\n");
             }
-            // Store the TravelRequest
-            // Find the requests tree for the given virus
-            VirusRequests *requests = static_cast<VirusRequests*>(target_country_to->virus_requests->getElement(virus_name, compareNameVirusRequests));
-            if (requests == NULL)
-            // No requests tree exists for this virus, so create one now
+            // Store the Travel Request
+            storeTravelRequest(target_country_to, virus_name, date, accepted);
+            if (request_log != NULL && !appendRequestLog(request_log, target_country_to->country_name, virus_name, date, accepted))
             {
-                target_country_to->virus_requests->append(new VirusRequests(virus_name));
-                requests = static_cast<VirusRequests*>(target_country_to->virus_requests->getLast());
+                fprintf(stderr, "Failed to write in travel request log\n");
             }
-            // Insert the request in the tree
-            requests->requests_tree->insert(new TravelRequest(date, accepted));
             // Increment the proper counter
             accepted ? accepted_requests++ : rejected_requests++;
         }
@@ -710,36 +1126,49 @@ void travelRequest(unsigned int citizen_id, Date &date, char *country_from, char
 }
 
 /**
- * While traversing the subtree starting with root recursively, 
- * counts the number of accepted and rejected requests between the two Dates
- * and updates the counters properly.
+ * Returns the index of the Country with the specified name in the countries array, or -1 if it does not exist.
+ * The countries array is sorted by Country name, so binary search is used.
  */
-void getTravelStatsRec(RBTreeNode *root, Date &start, Date &end, unsigned int &accepted, unsigned int &rejected)
+static int getCountryIndex(const char *country_name, CountryMonitor **countries, unsigned int num_countries)
 {
-    if (root == NULL) { return; }
-    // Getting the root Record
-    TravelRequest *root_data = static_cast<TravelRequest*>(root->data);
-
-    if (compareDates(&root_data->date, &start) >= 0)
-    // root Date is greater than start
+    unsigned int low = 0, high = num_countries;
+    while (low < high)
     {
-        // so count stats in Left subtree
-        getTravelStatsRec(root->left, start, end, accepted, rejected);
-        if (compareDates(&root_data->date, &end) <= 0)
-        // end is greater than root Date
+        unsigned int mid = low + (high - low) / 2;
+        int comparison = strcmp(country_name, countries[mid]->country_name);
+        if (comparison == 0)
         {
-            // root is in range, so update the correct counter
-            root_data->accepted ? accepted++ : rejected++;
-            // and count stats in the right subtree
-            getTravelStatsRec(root->right, start, end, accepted, rejected);
-            return;
+            return mid;
         }
+        (comparison < 0) ? (high = mid) : (low = mid + 1);
     }
-    // root is smaller than start, so just search to the right
-    if (compareDates(&root_data->date, &end) <= 0)
+    return -1;
+}
+
+/**
+ * Returns the CountryMonitor of the Country with the specified name, or NULL if it does not exist.
+ */
+CountryMonitor* getCountryMonitor(const char *country_name, CountryMonitor **countries, unsigned int num_countries)
+{
+    int index = getCountryIndex(country_name, countries, num_countries);
+    return (index == -1) ? NULL : countries[index];
+}
+
+/**
+ * Stores the specified Travel Request in the VirusRequests of the given (destination) Country.
+ */
+void storeTravelRequest(CountryMonitor *country, const char *virus_name, Date &date, bool accepted)
+{
+    // Find the requests tree for the given virus
+    VirusRequests *requests = static_cast<VirusRequests*>(country->virus_requests->getElement((void*)virus_name, compareNameVirusRequests));
+    if (requests == NULL)
+    // No requests tree exists for this virus, so create one now
     {
-        getTravelStatsRec(root->right, start, end, accepted, rejected);
+        country->virus_requests->append(new VirusRequests(virus_name));
+        requests = static_cast<VirusRequests*>(country->virus_requests->getLast());
     }
+    // Count the request in the day of its date
+    (accepted ? requests->accepted : requests->rejected)->add(date, 1);
 }
 
 /**
@@ -752,12 +1181,13 @@ void travelStats(char *virus_name, Date &start, Date &end, CountryMonitor **coun
     // Iterate over the countries
     for (int i = 0; i < num_countries; i++)
     {
-        // Get the requests tree for the target Virus related to each Country
+        // Get the request counters for the target Virus related to each Country
         VirusRequests *virus_requests = static_cast<VirusRequests*>(countries[i]->virus_requests->getElement(virus_name, compareNameVirusRequests));
         if (virus_requests != NULL)
-        // Tree found, so count stats
+        // Counters found, so count stats
         {
-            getTravelStatsRec(virus_requests->requests_tree->root, start, end, accepted_requests, rejected_requests);
+            accepted_requests += virus_requests->accepted->count(start, end);
+            rejected_requests += virus_requests->rejected->count(start, end);
         }
     }
     // Display results
@@ -787,12 +1217,13 @@ void travelStats(char *virus_name, Date &start, Date &end, const char *country_n
         if (strcmp(country_name, countries[i]->country_name) == 0)
         // Country found
         {
-            // Get the requests tree for the target Virus related to this Country
+            // Get the request counters for the target Virus related to this Country
             VirusRequests *virus_requests = static_cast<VirusRequests*>(countries[i]->virus_requests->getElement(virus_name, compareNameVirusRequests));
             if (virus_requests != NULL)
-            // Tree found, so count stats
+            // Counters found, so count stats
             {
-                getTravelStatsRec(virus_requests->requests_tree->root, start, end, accepted_requests, rejected_requests);
+                accepted_requests += virus_requests->accepted->count(start, end);
+                rejected_requests += virus_requests->rejected->count(start, end);
             }
             break;
         }
@@ -811,6 +1242,421 @@ void travelStats(char *virus_name, Date &start, Date &end, const char *country_n
     }
 }
 
+/**
+ * Requests the population statistics regarding the specified virus from the given Monitors
+ * (all the requests are sent before receiving any answer, so the Monitors serve them in parallel),
+ * and adds the received statistics of each Country in the stats array (indexed like the countries array).
+ * If country_name is not NULL, only the statistics of this Country are requested.
+ */
+static void receivePopulationStats(char *virus_name, Date &start, Date &end, const char *country_name,
+                                   MonitorInfo **monitors, unsigned int num_monitors,
+                                   CountryMonitor **countries, unsigned int num_countries, PopulationStats *stats,
+                                   char *buffer, unsigned int buffer_size)
+{
+    // Setting up structs required by select()
+    fd_set fdset;
+    struct timeval timeout;
+    timeout.tv_sec = 10;
+    timeout.tv_usec = 0;
+    FD_ZERO(&fdset);
+
+    bool *done = new bool[num_monitors];
+    unsigned int done_monitors = 0;
+    int max_fd = -1;
+    for (unsigned int i = 0; i < num_monitors; i++)
+    {
+        // Send the request to all Monitors and notify with SIGUSR2
+        sendMessageType(monitors[i]->io_fd, POPULATION_STATUS, buffer, buffer_size);
+        sendString(monitors[i]->io_fd, virus_name, buffer, buffer_size);
+        sendString(monitors[i]->io_fd, (country_name == NULL) ? "" : country_name, buffer, buffer_size);
+        sendDate(monitors[i]->io_fd, start, buffer, buffer_size);
+        sendDate(monitors[i]->io_fd, end, buffer, buffer_size);
+        kill(monitors[i]->process_id, SIGUSR2);
+        // Add each FD to the set and find max FD to pass to select()
+        FD_SET(monitors[i]->io_fd, &fdset);
+        if (max_fd < monitors[i]->io_fd)
+        {
+            max_fd = monitors[i]->io_fd;
+        }
+        done[i] = false;
+    }
+
+    // Keep looping until all Monitors have answered
+    while (done_monitors != num_monitors)
+    {
+        int ready_fds = select(max_fd + 1, &fdset, NULL, NULL, &timeout);
+        if (ready_fds == -1)
+        {
+            perror("Error/Timeout after waiting to receive population status answers.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (unsigned int i = 0; i < num_monitors && ready_fds != 0; i++)
+        {
+            if (done[i] || !FD_ISSET(monitors[i]->io_fd, &fdset)) { continue; }
+            // The answer of this Monitor is ready: receive the statistics of each country
+            unsigned int monitor_countries;
+            receiveInt(monitors[i]->io_fd, monitor_countries, buffer, buffer_size);
+            for (unsigned int j = 0; j < monitor_countries; j++)
+            {
+                char *name;
+                unsigned int population, vaccinated;
+                receiveString(monitors[i]->io_fd, name, buffer, buffer_size);
+                int index = getCountryIndex(name, countries, num_countries);
+                free(name);
+                if (index != -1)
+                {
+                    stats[index].reported = true;
+                }
+                for (unsigned int k = 0; k < AGE_GROUPS; k++)
+                {
+                    receiveInt(monitors[i]->io_fd, population, buffer, buffer_size);
+                    receiveInt(monitors[i]->io_fd, vaccinated, buffer, buffer_size);
+                    if (index != -1)
+                    {
+                        stats[index].population[k] += population;
+                        stats[index].vaccinated[k] += vaccinated;
+                    }
+                }
+            }
+            done[i] = true;
+            done_monitors++;
+        }
+        // Clear the set and add the FD's of the Monitors that have not answered yet
+        FD_ZERO(&fdset);
+        for (unsigned int i = 0; i < num_monitors; i++)
+        {
+            if (!done[i])
+            {
+                FD_SET(monitors[i]->io_fd, &fdset);
+            }
+        }
+    }
+    delete[] done;
+}
+
+/**
+ * Collects the population statistics needed for /populationStatus and /popStatusByAge.
+ * If country_name is not NULL, only the Monitor of this Country is asked, otherwise all the Monitors are.
+ *
+ * @returns An array with the statistics of each Country (indexed like the countries array),
+ * or NULL if the specified Country was not found. The array must be deleted after use.
+ */
+static PopulationStats* collectPopulationStats(char *virus_name, Date &start, Date &end, const char *country_name,
+                                               MonitorInfo **monitors, unsigned int active_monitors,
+                                               CountryMonitor **countries, unsigned int num_countries,
+                                               char *buffer, unsigned int buffer_size)
+{
+    PopulationStats *stats;
+    if (country_name == NULL)
+    {
+        stats = new PopulationStats[num_countries];
+        receivePopulationStats(virus_name, start, end, NULL, monitors, active_monitors,
+                               countries, num_countries, stats, buffer, buffer_size);
+    }
+    else
+    {
+        CountryMonitor *country = getCountryMonitor(country_name, countries, num_countries);
+        if (country == NULL)
+        {
+            printf("ERROR: The specified country was not found.\n");
+            return NULL;
+        }
+        stats = new PopulationStats[num_countries];
+        receivePopulationStats(virus_name, start, end, country_name, &country->monitor, 1,
+                               countries, num_countries, stats, buffer, buffer_size);
+    }
+    return stats;
+}
+
+/**
+ * Returns the given part of the given total as a percentage (0 if the total is 0).
+ */
+static float percentage(unsigned int part, unsigned int total)
+{
+    return (total == 0) ? 0 : (float)part / (float)total * 100;
+}
+
+/**
+ * Executes the /populationStatus command with the specified arguments.
+ * If the Dates are null, all the vaccinations are counted.
+ * If country_name is NULL, the statistics of all the countries with records about the virus are displayed.
+ */
+void populationStatus(char *virus_name, Date &start, Date &end, const char *country_name,
+                      MonitorInfo **monitors, unsigned int active_monitors, CountryMonitor **countries, unsigned int num_countries,
+                      char *buffer, unsigned int buffer_size)
+{
+    PopulationStats *stats = collectPopulationStats(virus_name, start, end, country_name, monitors, active_monitors,
+                                                    countries, num_countries, buffer, buffer_size);
+    if (stats == NULL) { return; }
+
+    for (unsigned int i = 0; i < num_countries; i++)
+    {
+        if (country_name != NULL && strcmp(country_name, countries[i]->country_name) != 0) { continue; }
+        // Countries without any record about the virus are only displayed if requested explicitly
+        if (country_name == NULL && !stats[i].reported) { continue; }
+        // Display the totals of all the age groups
+        unsigned int population = 0, vaccinated = 0;
+        for (unsigned int k = 0; k < AGE_GROUPS; k++)
+        {
+            population += stats[i].population[k];
+            vaccinated += stats[i].vaccinated[k];
+        }
+        printf("%s %u %.2f%%\n", countries[i]->country_name, vaccinated, percentage(vaccinated, population));
+    }
+    delete[] stats;
+}
+
+/**
+ * Executes the /popStatusByAge command with the specified arguments.
+ * If the Dates are null, all the vaccinations are counted.
+ * If country_name is NULL, the statistics of all the countries with records about the virus are displayed.
+ */
+void popStatusByAge(char *virus_name, Date &start, Date &end, const char *country_name,
+                    MonitorInfo **monitors, unsigned int active_monitors, CountryMonitor **countries, unsigned int num_countries,
+                    char *buffer, unsigned int buffer_size)
+{
+    const char *age_groups[AGE_GROUPS] = { "0-20", "20-40", "40-60", "60+" };
+    PopulationStats *stats = collectPopulationStats(virus_name, start, end, country_name, monitors, active_monitors,
+                                                    countries, num_countries, buffer, buffer_size);
+    if (stats == NULL) { return; }
+
+    for (unsigned int i = 0; i < num_countries; i++)
+    {
+        if (country_name != NULL && strcmp(country_name, countries[i]->country_name) != 0) { continue; }
+        // Countries without any record about the virus are only displayed if requested explicitly
+        if (country_name == NULL && !stats[i].reported) { continue; }
+        printf("%s\n", countries[i]->country_name);
+        for (unsigned int k = 0; k < AGE_GROUPS; k++)
+        {
+            printf("%s %u %.2f%%\n", age_groups[k], stats[i].vaccinated[k],
+                   percentage(stats[i].vaccinated[k], stats[i].population[k]));
+        }
+    }
+    delete[] stats;
+}
+
+/**
+ * Requests the runtime statistics from the given Monitors (all the requests are sent before receiving
+ * any answer, so the Monitors serve them in parallel), and adds them to the given MonitorStats.
+ */
+static void receiveMonitorStats(MonitorInfo **monitors, unsigned int num_monitors, MonitorStats &stats,
+                                char *buffer, unsigned int buffer_size)
+{
+    // Setting up structs required by select()
+    fd_set fdset;
+    struct timeval timeout;
+    timeout.tv_sec = 10;
+    timeout.tv_usec = 0;
+    FD_ZERO(&fdset);
+
+    bool *done = new bool[num_monitors];
+    unsigned int done_monitors = 0;
+    int max_fd = -1;
+    for (unsigned int i = 0; i < num_monitors; i++)
+    {
+        // Send the request to all Monitors and notify with SIGUSR2
+        sendMessageType(monitors[i]->io_fd, MONITOR_STATS, buffer, buffer_size);
+        kill(monitors[i]->process_id, SIGUSR2);
+        // Add each FD to the set and find max FD to pass to select()
+        FD_SET(monitors[i]->io_fd, &fdset);
+        if (max_fd < monitors[i]->io_fd)
+        {
+            max_fd = monitors[i]->io_fd;
+        }
+        done[i] = false;
+    }
+
+    // Keep looping until all Monitors have answered
+    while (done_monitors != num_monitors)
+    {
+        int ready_fds = select(max_fd + 1, &fdset, NULL, NULL, &timeout);
+        if (ready_fds == -1)
+        {
+            perror("Error/Timeout after waiting to receive runtime statistics.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (unsigned int i = 0; i < num_monitors && ready_fds != 0; i++)
+        {
+            if (done[i] || !FD_ISSET(monitors[i]->io_fd, &fdset)) { continue; }
+            // The answer of this Monitor is ready
+            int fd = monitors[i]->io_fd;
+            unsigned long long value;
+            receiveLongInt(fd, value, buffer, buffer_size);
+            stats.records_parsed += value;
+            receiveLongInt(fd, value, buffer, buffer_size);
+            stats.records_rejected += value;
+            for (unsigned int j = 0; j < TRAFFIC_ROUTINES; j++)
+            {
+                receiveLongInt(fd, value, buffer, buffer_size);
+                stats.sent_calls[j] += value;
+                receiveLongInt(fd, value, buffer, buffer_size);
+                stats.sent_bytes[j] += value;
+                receiveLongInt(fd, value, buffer, buffer_size);
+                stats.received_calls[j] += value;
+                receiveLongInt(fd, value, buffer, buffer_size);
+                stats.received_bytes[j] += value;
+            }
+            for (unsigned int j = 0; j < STATS_MONITOR_OPERATIONS; j++)
+            {
+                updateLatencyHistogram(fd, stats.operation_latencies[j], buffer, buffer_size);
+            }
+            done[i] = true;
+            done_monitors++;
+        }
+        // Clear the set and add the FD's of the Monitors that have not answered yet
+        FD_ZERO(&fdset);
+        for (unsigned int i = 0; i < num_monitors; i++)
+        {
+            if (!done[i])
+            {
+                FD_SET(monitors[i]->io_fd, &fdset);
+            }
+        }
+    }
+    delete[] done;
+}
+
+/**
+ * Prints the number, the average and the p50/p99/p99.9 bounds of the latencies in the given histogram.
+ */
+static void printLatencies(const char *name, const LatencyHistogram &histogram)
+{
+    unsigned long long count = histogram.getCount();
+    if (count == 0)
+    {
+        printf("%s: 0\n", name);
+        return;
+    }
+    printf("%s: %llu, avg %llu us", name, count, histogram.getTotalMicros() / count);
+    printf(", p50 < %llu us, p99 < %llu us, p99.9 < %llu us\n", histogram.percentileBound(50),
+           histogram.percentileBound(99), histogram.percentileBound(99.9));
+}
+
+/**
+ * Executes the /stats command: displays the record counters of the Monitors, the Bloom Filter lookups
+ * of each virus (and the observed false positive rate), the traffic of each messaging routine
+ * (in the Parent and in the Monitors), and the latencies of the commands & the Monitor operations.
+ */
+void runtimeStats(LinkedList *viruses, MonitorInfo **monitors, unsigned int active_monitors,
+                  const LatencyHistogram *command_latencies, char *buffer, unsigned int buffer_size)
+{
+    const char *command_names[PARENT_COMMANDS] = { "/travelRequest", "/travelStats", "/populationStatus",
+                                                   "/popStatusByAge", "/addVaccinationRecords", "/searchVaccinationStatus" };
+    const char *operation_names[STATS_MONITOR_OPERATIONS] = { "travelRequest", "searchVaccinationStatus",
+                                                              "populationStatus", "file updates" };
+    MonitorStats stats;
+    receiveMonitorStats(monitors, active_monitors, stats, buffer, buffer_size);
+
+    printf("RECORDS PARSED %llu\n", stats.records_parsed);
+    printf("RECORDS REJECTED %llu\n", stats.records_rejected);
+
+    printf("BLOOM FILTER LOOKUPS\n");
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusFilter *virus = static_cast<VirusFilter*>(itr.getData());
+        unsigned long long positives = virus->positives.get();
+        unsigned long long false_positives = positives - virus->hits.get();
+        printf("%s: %llu lookups, %llu positives, %llu false positives (%.2f%%), %llu decided from cache\n", virus->virus_name,
+               virus->lookups.get(), positives, false_positives,
+               (positives == 0) ? 0.0 : (100.0 * false_positives) / positives, virus->cached.get());
+    }
+
+    printf("TRAFFIC (CALLS/BYTES) PARENT, MONITORS\n");
+    for (unsigned int i = 0; i < TRAFFIC_ROUTINES; i++)
+    {
+        printf("%s: %llu/%llu, %llu/%llu\n", send_routine_names[i], sent_traffic[i].calls.get(), sent_traffic[i].bytes.get(),
+               stats.sent_calls[i], stats.sent_bytes[i]);
+        printf("%s: %llu/%llu, %llu/%llu\n", receive_routine_names[i], received_traffic[i].calls.get(),
+               received_traffic[i].bytes.get(), stats.received_calls[i], stats.received_bytes[i]);
+    }
+
+    printf("COMMAND LATENCIES\n");
+    for (unsigned int i = 0; i < PARENT_COMMANDS; i++)
+    {
+        printLatencies(command_names[i], command_latencies[i]);
+    }
+    printf("MONITOR OPERATION LATENCIES\n");
+    for (unsigned int i = 0; i < STATS_MONITOR_OPERATIONS; i++)
+    {
+        printLatencies(operation_names[i], stats.operation_latencies[i]);
+    }
+}
+
+/**
+ * Executes the /bloomStats command: displays the fill ratio of each stage of the Bloom Filter of each virus,
+ * the estimated number of citizens marked in it and the estimated & observed false positive rates,
+ * as well as the recommended filter size & number of Hash Functions for the estimated number of citizens.
+ * The total memory of the filters is compared with the memory they would need with the recommended sizes.
+ * Since bloom_size is the maximum size of any filter, the recommended -n argument is the largest estimation.
+ * In MEMBERSHIP_EXACT mode, the number of citizens & the size of the ID bitmap of each virus are displayed instead.
+ */
+void bloomStats(LinkedList *viruses, unsigned long bloom_size)
+{
+    unsigned long long total_bytes = 0, total_recommended = 0;
+    double max_items = 0;
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusFilter *virus = static_cast<VirusFilter*>(itr.getData());
+        unsigned long long positives = virus->positives.get();
+        unsigned long long false_positives = positives - virus->hits.get();
+        if (virus->ids != NULL)
+        // MEMBERSHIP_EXACT mode, so there are no false positives (and the bitmap is kept as it is)
+        {
+            RoaringBitmap *ids = virus->ids;
+            printf("%s: exact ID bitmap, %lu vaccinations, %lu bytes in %u container(s) (%u array, %u bitset)\n",
+                   virus->virus_name, ids->getCardinality(), ids->getNumBytes(), ids->getNumContainers(),
+                   ids->getNumArrayContainers(), ids->getNumContainers() - ids->getNumArrayContainers());
+            printf("False positives: %llu of %llu positives\n", false_positives, positives);
+            total_bytes += ids->getNumBytes();
+            total_recommended += ids->getNumBytes();
+            if (ids->getCardinality() > max_items)
+            {
+                max_items = ids->getCardinality();
+            }
+            continue;
+        }
+        ScalableBloomFilter *filter = virus->filter;
+        double items = filter->estimatedItems();
+
+        printf("%s: %lu bytes in %u filter(s), ~%.0f citizens\n", virus->virus_name, filter->getNumBytes(),
+               filter->getNumStages(), items);
+        bool saturated = false;
+        for (unsigned int i = 0; i < filter->getNumStages(); i++)
+        {
+            BloomFilter *stage = filter->getStage(i);
+            unsigned long set_bits = stage->countSetBits();
+            printf("Filter %u: %lu bytes, %u hash functions, %lu bits set (%.2f%% full)\n", i + 1, stage->numBytes,
+                   stage->numHashes, set_bits, 100.0 * stage->fillRatio());
+            saturated = saturated || (set_bits == stage->numBytes*8);
+        }
+        printf("False positive rate: estimated %.4f%%, observed %.4f%% (%llu of %llu positives)\n",
+               100 * filter->estimatedFalsePositiveRate(),
+               (positives == 0) ? 0.0 : (100.0 * false_positives) / positives, false_positives, positives);
+        total_bytes += filter->getNumBytes();
+        if (saturated)
+        // Saturated filter, so the number of citizens cannot be estimated
+        {
+            printf("Recommended size: unknown (the filter is full)\n");
+            total_recommended += MAX_BLOOM_SIZE;
+            max_items = MAX_BLOOM_SIZE * 8 * M_LN2 / K_MAX;
+            continue;
+        }
+        unsigned long recommended;
+        unsigned int recommended_hashes;
+        BloomFilter::chooseParameters((unsigned long)ceil(items), MAX_BLOOM_SIZE, recommended, recommended_hashes);
+        printf("Recommended size: %lu bytes, %u hash functions\n", recommended, recommended_hashes);
+        total_recommended += recommended;
+        if (items > max_items)
+        {
+            max_items = items;
+        }
+    }
+    printf("TOTAL %llu bytes, %llu bytes with the recommended sizes\n", total_bytes, total_recommended);
+    unsigned long uniform_size = BloomFilter::optimalSize((unsigned long)ceil(max_items));
+    if (uniform_size > MAX_BLOOM_SIZE) { uniform_size = MAX_BLOOM_SIZE; }
+    printf("Current maximum -s %lu, recommended -n %lu (-s %lu)\n", bloom_size, (unsigned long)ceil(max_items), uniform_size);
+}
+
 /**
  * Terminates all Monitor processes and deletes the created pipes.
  */
@@ -872,23 +1718,6 @@ int compareNameVirusFilter(void *name, void *filter)
     return strcmp(static_cast<char*>(name), static_cast<VirusFilter*>(filter)->virus_name);
 }
 
-/**
- * Compares the 2 TravelRequest objects based on their dates first.
- * Since 2 requests must always by considered different, if the dates are equal,
- * either -1 or 1 will be returned randomly.
- */
-int compareTravelRequests(void *r1, void *r2)
-{
-    TravelRequest *req1 = static_cast<TravelRequest*>(r1);
-    TravelRequest *req2 = static_cast<TravelRequest*>(r2);
-
-    int comp = compareDates(req1->date, req2->date);
-    if (comp != 0) { return comp; }
-
-    // return either -1 or 1
-    return -1 + (rand() % 2) * 2;
-}
-
 /**
  * Compares the given name to the virus name of the specified VirusRequests object.
  * Returns 0 if they are equal, non-zero otherwise.
@@ -8,6 +8,21 @@
 #define PARENT_MONITOR_UTILS_HPP
 
 #include "app_utils.hpp"
+#include "../include/messaging.hpp"
+
+/* Commands with separate latency histograms (see parseExecuteCommand). */
+#define CMD_TRAVEL_REQUEST 0
+#define CMD_TRAVEL_STATS 1
+#define CMD_POPULATION_STATUS 2
+#define CMD_POP_STATUS_BY_AGE 3
+#define CMD_ADD_RECORDS 4
+#define CMD_SEARCH_STATUS 5
+#define PARENT_COMMANDS 6
+
+#define VACCINATION_CACHE_BUCKETS 1000  // Number of buckets for the vaccination date cache of each Monitor
+#define VACCINATION_CACHE_CAPACITY 10000    // Max cached vaccination dates of each Monitor (the cache is cleared when full)
+
+class CachedVaccination;
 
 /**
  * Stores information about a specific child Monitor process.
@@ -21,21 +36,27 @@ class MonitorInfo
         int io_fd;                      // The FD returned be accept(), used for reading/writing data.
         
         LinkedList *subdirs;            // A list with the subdirectories (paths) assigned to this Monitor
+        unsigned long long assigned_bytes;  // The total bytes of the files in the assigned subdirectories
+        HashTable *vaccination_cache;   // The vaccination dates sent by the Monitor (see CachedVaccination)
+        unsigned int cached_vaccinations;   // The number of vaccination dates in the cache
         MonitorInfo();
         ~MonitorInfo();
         bool createSocket(uint16_t &port);
         bool establishConnection();
         void terminateConnection();
+        void clearVaccinationCache();
+        void cacheVaccination(CachedVaccination *cached);
 };
 
 /**
- * Stores Travel Requests, sorted by date in a Red-Black Tree, about a specific virus.
+ * Stores the number of accepted & rejected Travel Requests of each day, about a specific virus.
  */
 class VirusRequests
 {
     public:
         const char *virus_name;
-        RedBlackTree *requests_tree;
+        DateCounter *accepted;          // The number of accepted requests of each day
+        DateCounter *rejected;          // The number of rejected requests of each day
         VirusRequests(const char *name);
         ~VirusRequests();
 };
@@ -49,43 +70,99 @@ class CountryMonitor
     public:
         const char *country_name;
         MonitorInfo *monitor;
+        unsigned long long bytes;       // The total bytes of the files in the country directory, when it was assigned
         LinkedList *virus_requests;
         CountryMonitor(const char *name, MonitorInfo *monitor_info);
         ~CountryMonitor();
 };
 
 /**
- * Represents a Travel Request in a specific date, which has been
- * either accepted or rejected.
+ * The vaccination date of a citizen for a specific virus, as sent by the Monitor of the origin country
+ * of a Travel Request. Later requests of the citizen from the same country are decided by the Parent,
+ * until the Monitor sends new filters (see MonitorInfo::clearVaccinationCache).
  */
-class TravelRequest
+class CachedVaccination
 {
     public:
+        unsigned int citizen_id;
+        const char *virus_name;                 // The name stored in the VirusFilter of the virus
+        const CountryMonitor *country_from;
         Date date;
-        const bool accepted;
-        TravelRequest(Date &request_date, bool is_accepted);
-        ~TravelRequest(); 
+        CachedVaccination(unsigned int id, const char *virus, const CountryMonitor *country, const Date &vaccination_date);
+};
+
+/**
+ * Stores the total & vaccinated population of each age group in a specific country,
+ * regarding a specific virus (as reported by the Monitor of the country).
+ */
+class PopulationStats
+{
+    public:
+        unsigned int population[AGE_GROUPS];
+        unsigned int vaccinated[AGE_GROUPS];
+        bool reported;          // TRUE if a Monitor has records about the virus for this Country
+        PopulationStats();
+};
+
+/**
+ * Stores the runtime statistics reported by the Monitors (summed over all the Monitors).
+ */
+class MonitorStats
+{
+    public:
+        unsigned long long records_parsed;
+        unsigned long long records_rejected;
+        unsigned long long sent_calls[TRAFFIC_ROUTINES];
+        unsigned long long sent_bytes[TRAFFIC_ROUTINES];
+        unsigned long long received_calls[TRAFFIC_ROUTINES];
+        unsigned long long received_bytes[TRAFFIC_ROUTINES];
+        LatencyHistogram operation_latencies[STATS_MONITOR_OPERATIONS];
+        MonitorStats();
 };
 
 /**
- * Stores a Bloom Filter related to a specific virus.
+ * Stores a Bloom Filter related to a specific virus,
+ * or the exact vaccinated citizen ID's in MEMBERSHIP_EXACT mode.
  */
 class VirusFilter
 {
     public:
         const char *virus_name;
-        BloomFilter *filter;
-        VirusFilter(const char *name, unsigned long size);
+        ScalableBloomFilter *filter;    // NULL in MEMBERSHIP_EXACT mode
+        RoaringBitmap *ids;             // The vaccinated citizen ID's (NULL in MEMBERSHIP_BLOOM mode)
+        Counter lookups;                // The Travel Requests that checked the filter
+        Counter positives;              // The lookups that found the citizen "maybe present"
+        Counter hits;                   // The positives for which the Monitor found a vaccination record
+        Counter cached;                 // The positives decided using the vaccination date cache (no Monitor request)
+        VirusFilter(const char *name, ScalableBloomFilter *virus_filter, RoaringBitmap *virus_ids = NULL);
         ~VirusFilter();
 };
 
+/**
+ * The number of vaccinated citizens of a virus, sent by a Monitor before building its Bloom Filters.
+ * On startup, the counts of all the Monitors are stored until they have all been received,
+ * so that the filter of each virus can be sized for their total.
+ */
+class VaccinatedCount
+{
+    public:
+        MonitorInfo *monitor;       // The Monitor that sent the count.
+        char *virus_name;
+        unsigned long count;
+        unsigned long total;        // The total count of all the Monitors for this virus (once all the counts are received).
+        VaccinatedCount(MonitorInfo *sender, char *name, unsigned long vaccinated);
+        ~VaccinatedCount();
+};
+
 /* Parent Monitor routines --------------------------------------------------------------------- */
 
+unsigned long long directoryBytes(const char *path);
+
 bool assignMonitorDirectories(char *path, CountryMonitor **&countries, MonitorInfo **&monitors, unsigned int num_monitors,
-                              struct dirent **&files, unsigned int &num_files);
+                              struct dirent **&files, unsigned int &num_files, int placement);
 
 void buildBasicArgv(char **&argv, unsigned int num_threads, unsigned int buffer_size,
-                    unsigned int cyclic_buffer_size, unsigned long bloom_size);
+                    unsigned int cyclic_buffer_size, unsigned long bloom_size, int membership);
 
 void deleteBasicArgv(char **argv);
 
@@ -94,11 +171,11 @@ void buildChildArgv(char **&argv, MonitorInfo *monitor, uint16_t port);
 void createMonitors(MonitorInfo **monitors, unsigned int num_monitors, unsigned int &active_monitors,
                     char **child_argv);
 
-void restoreChild(MonitorInfo *monitor, char *buffer, unsigned int buffer_size, unsigned long int bloom_size,
+void restoreChild(MonitorInfo *monitor, char *buffer, unsigned int buffer_size,
                   LinkedList *viruses, char **child_argv);
 
 void checkAndRestoreChildren(MonitorInfo **monitors, unsigned int num_monitors, char *buffer, unsigned int buffer_size,
-                             unsigned long int bloom_size, LinkedList *viruses, int &sigchld_counter, char **child_argv);
+                             LinkedList *viruses, int &sigchld_counter, char **child_argv);
 
 void sendMonitorData(MonitorInfo **monitors, unsigned int num_monitors, char *buffer, unsigned int buffer_size);
 
@@ -106,23 +183,39 @@ void receiveMonitorFilters(MonitorInfo **monitors, unsigned int num_monitors, Li
                            char *buffer, unsigned int buffer_size, unsigned long int bloom_size);
 
 void addVaccinationRecords(const char *country_name, CountryMonitor **countries, unsigned int num_countries,
-                           LinkedList *viruses, char *buffer, unsigned int buffer_size, unsigned long int bloom_size);
+                           LinkedList *viruses, char *buffer, unsigned int buffer_size);
 
 void searchVaccinationStatus(unsigned int citizen_id, MonitorInfo **monitors, unsigned int active_monitors,
                              char *buffer, unsigned int buffer_size);
 
+CountryMonitor* getCountryMonitor(const char *country_name, CountryMonitor **countries, unsigned int num_countries);
+
+void storeTravelRequest(CountryMonitor *country, const char *virus_name, Date &date, bool accepted);
+
 void travelRequest(unsigned int citizen_id, Date &date, char *country_from, char *country_to, char *virus_name,
                    LinkedList *viruses, MonitorInfo **monitors, unsigned int active_monitors,
                    CountryMonitor **countries, unsigned int num_countries,
-                   char *buffer, unsigned int buffer_size, unsigned int &accepted_requests, unsigned int &rejected_requests); 
-
-void getTravelStatsRec(RBTreeNode *root, Date &start, Date &end, unsigned int &accepted, unsigned int &rejected);
+                   char *buffer, unsigned int buffer_size, unsigned int &accepted_requests, unsigned int &rejected_requests,
+                   FILE *request_log); 
 
 void travelStats(char *virus_name, Date &start, Date &end, CountryMonitor **countries, unsigned int num_countries);
 
 void travelStats(char *virus_name, Date &start, Date &end, const char *country_name,
                  CountryMonitor **countries, unsigned int num_countries); 
 
+void populationStatus(char *virus_name, Date &start, Date &end, const char *country_name,
+                      MonitorInfo **monitors, unsigned int active_monitors, CountryMonitor **countries, unsigned int num_countries,
+                      char *buffer, unsigned int buffer_size);
+
+void popStatusByAge(char *virus_name, Date &start, Date &end, const char *country_name,
+                    MonitorInfo **monitors, unsigned int active_monitors, CountryMonitor **countries, unsigned int num_countries,
+                    char *buffer, unsigned int buffer_size);
+
+void runtimeStats(LinkedList *viruses, MonitorInfo **monitors, unsigned int active_monitors,
+                  const LatencyHistogram *command_latencies, char *buffer, unsigned int buffer_size);
+
+void bloomStats(LinkedList *viruses, unsigned long bloom_size);
+
 void terminateChildren(MonitorInfo **monitors, unsigned int num_monitors, char *buffer, unsigned int buffer_size);
 
 void releaseResources(CountryMonitor **countries, MonitorInfo **monitors, unsigned int num_monitors,
@@ -131,7 +224,6 @@ void releaseResources(CountryMonitor **countries, MonitorInfo **monitors, unsign
 /* Comparison functions to be used by ADT's ----------------------------------------------------- */
 
 int compareNameVirusFilter(void *name, void *filter);
-int compareTravelRequests(void *r1, void *r2);
 int compareNameVirusRequests(void *name, void *req);
 
 #endif
@@ -8,7 +8,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cassert>
+#include <cmath>
 
+#include "../include/bloom_filter.hpp"
 #include "app_utils.hpp"
 #include "parse_utils.hpp"
 
@@ -77,6 +79,15 @@ char* fgetline(FILE *stream)
  * Routines used for command argument parsing-checking --------------------------------------------
  */
 
+/**
+ * Returns the next token of the string being parsed, using strtok_r() with the given
+ * save pointer, or strtok() if saveptr is NULL.
+ */
+static char* nextToken(char **saveptr)
+{
+    return (saveptr == NULL) ? strtok(NULL, " ") : strtok_r(NULL, " ", saveptr);
+}
+
 /**
  * @brief Parses the string stored in strtok buffer into /insertCitizenRecord
  * command arguments, and stores the argument values in the specified variables.
@@ -91,15 +102,18 @@ char* fgetline(FILE *stream)
  * a null Date will be stored.
  * @param fstream The file stream to print output messages. If output is not desirable,
  * NULL can be passed.
+ * @param saveptr If not NULL, the string is parsed using strtok_r() with this save pointer
+ * (so that many threads can parse records at the same time), instead of strtok().
  * 
  * @returns TRUE if parsing was successful, FALSE if an error/bad argument was detected.
  */
 bool insertCitizenRecordParse(int &citizen_id, char *&citizen_fullname, char *&country_name,
-                              int &citizen_age, char *&virus_name, bool &vaccinated, Date &date, FILE *fstream)
+                              int &citizen_age, char *&virus_name, bool &vaccinated, Date &date, FILE *fstream,
+                              char **saveptr)
 {
     short int curr_arg = 1;     // This indicates which argument is examined
     char *fname = NULL;         // A temporary buffer for the Citizen First name
-    char *token;                // This is used to obtain the token returned by strtok
+    char *token;                // This is used to obtain the token returned by nextToken
     
     // Initializing the given arguments to NULL
     citizen_fullname = NULL;
@@ -107,8 +121,8 @@ bool insertCitizenRecordParse(int &citizen_id, char *&citizen_fullname, char *&c
     virus_name = NULL;
     date.set(0, 0, 0);
 
-    // Loop until strtok no longer gives other tokens or more than expected arguments detected
-    while ( (token = strtok(NULL, " "))!= NULL && curr_arg <= 9 )
+    // Loop until nextToken no longer gives other tokens or more than expected arguments detected
+    while ( (token = nextToken(saveptr))!= NULL && curr_arg <= 9 )
     {
         switch (curr_arg)
         {
@@ -166,7 +180,7 @@ bool insertCitizenRecordParse(int &citizen_id, char *&citizen_fullname, char *&c
                 else if (strcmp(token, "NO") == 0)
                 {
                     vaccinated = false;
-                    if ((token = strtok(NULL, " "))!= NULL)
+                    if ((token = nextToken(saveptr))!= NULL)
                     // argument was "NO" but there are still more arguments, which is unexpected.
                     {
                         displayMessage(fstream, "More than expected arguments have been detected. Rejecting command.\n");
@@ -217,20 +231,22 @@ bool insertCitizenRecordParse(int &citizen_id, char *&citizen_fullname, char *&c
  */
 bool childCheckparseArgs(int argc, char const *argv[], uint16_t &port,
                unsigned int &num_threads, unsigned int &buffer_size, unsigned int &cyclic_buffer_size,
-               DirectoryInfo **&directories, unsigned long &bloom_size, unsigned int &num_dirs)
+               DirectoryInfo **&directories, DirectoryWatcher *&watcher, unsigned long &bloom_size, int &membership,
+               unsigned int &num_dirs)
 {
-    if (argc < 11)
+    membership = MEMBERSHIP_BLOOM;
+    if (argc < 13)
     {
         fprintf(stderr, "Invalid number of arguments given.\n");
         fprintf(stderr, "Usage: ./monitorServer -p port -t numThreads -b socketBufferSize \
-        -c cyclicBufferSize -s sizeOfBloom <path1> ... <pathN>\n");
+        -c cyclicBufferSize -s sizeOfBloom -f bloom|exact <path1> ... <pathN>\n");
         return false;
     }
 
     // Flags to make sure no arguments are given more than once
     bool got_port = false, got_num_threads = false, got_socket_buf_size = false;
-    bool got_cyclic_buf_size = false, got_bloom_size = false;
-    for (int i = 1; i < 11; i+=2)
+    bool got_cyclic_buf_size = false, got_bloom_size = false, got_membership = false;
+    for (int i = 1; i < 13; i+=2)
     {
         if ( strcmp(argv[i], "-p") == 0 )
         {
@@ -304,6 +320,27 @@ bool childCheckparseArgs(int argc, char const *argv[], uint16_t &port,
                 return false;
             }
         }
+        else if ( strcmp(argv[i], "-f") == 0 )
+        {
+            if (got_membership) {
+                fprintf(stderr, "Duplicate membership argument detected.\n");
+                return false;
+            }
+            if (strcmp(argv[i + 1], "bloom") == 0)
+            {
+                membership = MEMBERSHIP_BLOOM;
+            }
+            else if (strcmp(argv[i + 1], "exact") == 0)
+            {
+                membership = MEMBERSHIP_EXACT;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid membership argument. Make sure it is \"bloom\" or \"exact\".\n");
+                return false;
+            }
+            got_membership = true;
+        }
         else
         {
             fprintf(stderr, "Invalid argument detected.\n");
@@ -311,31 +348,36 @@ bool childCheckparseArgs(int argc, char const *argv[], uint16_t &port,
         }
     }
     // Create a DirectoryInfo object for each of the received directory pahts.
-    num_dirs = argc - 11;
+    // All the directories are watched by the same watcher.
+    num_dirs = argc - 13;
     directories = new DirectoryInfo*[num_dirs];
+    watcher = new DirectoryWatcher();
     for (unsigned int i = 0; i < num_dirs; i++)
     {
-        directories[i] = new DirectoryInfo(argv[11 + i]);
+        directories[i] = new DirectoryInfo(argv[13 + i]);
         // Add the directory contents in the contents list
-        directories[i]->addContents();
+        directories[i]->addContents(watcher);
     }
     return true;
 }
 
 /**
  * Checks and stores the program arguments properly.
+ * The placement argument (-a rr|size) is optional, and it is PLACEMENT_ROUND_ROBIN by default (as before it existed).
  * @returns TRUE if the arguments are valid, FALSE otherwise.
  */
 bool parentCheckParseArgs(int argc, char const *argv[], char *&directory_path, unsigned int &num_monitors,
                     unsigned long &bloom_size, unsigned int &buffer_size, unsigned int &cyclic_buffer_size,
-                    unsigned int &num_threads)
+                    unsigned int &num_threads, int &placement, int &membership)
 {
     directory_path = NULL;
-    if (argc != 13)
+    placement = PLACEMENT_ROUND_ROBIN;
+    membership = MEMBERSHIP_BLOOM;
+    if (argc != 13 && argc != 15 && argc != 17)
     {
         fprintf(stderr, "Insufficient/Unexpected number of arguments given.\n");
         printf("Usage: ./travelMonitorClient -m numMonitors -b socketBufferSize -c cyclicBufferSize \
-                -s sizeOfBloom -i input_dir -t numThreads\n");
+                -s sizeOfBloom|-n expectedRecords -i input_dir -t numThreads [-a rr|size] [-f bloom|exact]\n");
         return false;
     }
 
@@ -346,8 +388,10 @@ bool parentCheckParseArgs(int argc, char const *argv[], char *&directory_path, u
     bool got_bloom_size = false;
     bool got_input_dir = false;
     bool got_num_threads = false;
+    bool got_placement = false;
+    bool got_membership = false;
 
-    for (int i = 1; i < 13; i+=2)
+    for (int i = 1; i < argc; i+=2)
     {
         if ( strcmp(argv[i], "-m") == 0 )
         {
@@ -406,7 +450,7 @@ bool parentCheckParseArgs(int argc, char const *argv[], char *&directory_path, u
         else if ( strcmp(argv[i], "-s") == 0 )
         {
             if (got_bloom_size) { 
-                fprintf(stderr, "Duplicate sizeOfBloom argument detected.\n");
+                fprintf(stderr, "Duplicate sizeOfBloom/expectedRecords argument detected.\n");
                 return false;
             }
             long temp = atol(argv[i + 1]);
@@ -421,6 +465,26 @@ bool parentCheckParseArgs(int argc, char const *argv[], char *&directory_path, u
                 return false;
             }
         }
+        else if ( strcmp(argv[i], "-n") == 0 )
+        // The Bloom Filter size is chosen based on the expected number of vaccinated citizens per virus
+        {
+            if (got_bloom_size) { 
+                fprintf(stderr, "Duplicate sizeOfBloom/expectedRecords argument detected.\n");
+                return false;
+            }
+            long temp = atol(argv[i + 1]);
+            if (temp > 0 && BloomFilter::optimalSize(temp) <= MAX_BLOOM_SIZE)
+            {
+                bloom_size = BloomFilter::optimalSize(temp);
+                got_bloom_size = true;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid expectedRecords argument. Make sure it is a positive integer up to %lu\n",
+                        (unsigned long)(MAX_BLOOM_SIZE * 8 * M_LN2 / K_MAX));
+                return false;
+            }
+        }
         else if ( strcmp(argv[i], "-i") == 0 )
         {
             if (got_input_dir) {
@@ -448,12 +512,60 @@ bool parentCheckParseArgs(int argc, char const *argv[], char *&directory_path, u
                 return false;
             }
         }
+        else if ( strcmp(argv[i], "-a") == 0 )
+        {
+            if (got_placement) {
+                fprintf(stderr, "Duplicate placement argument detected.\n");
+                return false;
+            }
+            if (strcmp(argv[i + 1], "rr") == 0)
+            {
+                placement = PLACEMENT_ROUND_ROBIN;
+            }
+            else if (strcmp(argv[i + 1], "size") == 0)
+            {
+                placement = PLACEMENT_SIZE;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid placement argument. Make sure it is \"rr\" or \"size\".\n");
+                return false;
+            }
+            got_placement = true;
+        }
+        else if ( strcmp(argv[i], "-f") == 0 )
+        // Membership mode: the Parent checks the merged Bloom Filters, or the exact vaccinated citizen ID's
+        {
+            if (got_membership) {
+                fprintf(stderr, "Duplicate membership argument detected.\n");
+                return false;
+            }
+            if (strcmp(argv[i + 1], "bloom") == 0)
+            {
+                membership = MEMBERSHIP_BLOOM;
+            }
+            else if (strcmp(argv[i + 1], "exact") == 0)
+            {
+                membership = MEMBERSHIP_EXACT;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid membership argument. Make sure it is \"bloom\" or \"exact\".\n");
+                return false;
+            }
+            got_membership = true;
+        }
         else
         {
             fprintf(stderr, "Invalid argument detected.\n");
             return false;
         }
     }
+    if (!(got_num_monitors && got_buffer_size && got_cyclic_buffer_size && got_bloom_size && got_input_dir && got_num_threads))
+    {
+        fprintf(stderr, "Insufficient arguments given.\n");
+        return false;
+    }
     return true;
 }
 
@@ -681,3 +793,124 @@ bool travelStatsParse(char *&virus_name, Date &start, Date &end, char *&country_
             break;
     }
 }
+
+/**
+ * Checks if the /populationStatus or /popStatusByAge command was valid and
+ * stores the user arguments in the given variables.
+ * If no Dates were given, null Dates are stored. If no Country was given, country_name is set to NULL.
+ */
+bool populationStatusParse(char *&country_name, char *&virus_name, Date &start, Date &end)
+{
+    char **args = new char*[4];     // The string arguments will be stored here initially
+    short int curr_arg = 0;         // This indicates which argument is examined
+    char *token;                    // This is used to obtain the token returned by strtok
+
+    // Initializing given arguments to NULL
+    start.set(0, 0, 0);
+    end.set(0, 0, 0);
+    country_name = NULL;
+    virus_name = NULL;
+
+    // Get all the user arguments
+    while ( (token = strtok(NULL, " "))!= NULL && curr_arg < 4)
+    {
+        args[curr_arg] = token;
+        curr_arg++;
+    }
+    if (token != NULL)
+    // Reject command if arguments were more than expected
+    {
+        printf("More than expected arguments have been detected. Rejecting command.\n");
+        delete[] args;
+        return false;
+    }
+    switch (curr_arg)
+    // Exam the number of given arguments, and parse accordingly
+    {
+        case 0:
+            printf("Less than expected arguments have been detected. Rejecting command.\n");
+            delete[] args;
+            return false;
+        case 1:
+            // args are: virus
+            virus_name = new char[strlen(args[0])+1];
+            strcpy(virus_name, args[0]);
+
+            delete[] args;
+            return true;
+        case 2:
+            // args are: country virus, or virus date1 (with the second date missing)
+            if (parseDateString(args[1], start))
+            {
+                start.set(0, 0, 0);
+                printf("Only one date argument has been detected. Rejecting command.\n");
+                delete[] args;
+                return false;
+            }
+            country_name = new char[strlen(args[0])+1];
+            strcpy(country_name, args[0]);
+            virus_name = new char[strlen(args[1])+1];
+            strcpy(virus_name, args[1]);
+
+            delete[] args;
+            return true;
+        case 3:
+            // args are: virus date1 date2
+            virus_name = new char[strlen(args[0])+1];
+            strcpy(virus_name, args[0]);
+
+            if ( !(parseDateString(args[1], start) && parseDateString(args[2], end)) )
+            {
+                delete[] args;
+                printf("Invalid date argument detected. Rejecting command.\n");
+                return false;
+            }
+            delete[] args;
+            if (compareDates(start, end) > 0)
+            {
+                printf("The first Date cannot be greater than the second one. Rejecting command.\n");
+                return false;
+            }
+            return true;
+        case 4:
+            // args are: country virus date1 date2
+            country_name = new char[strlen(args[0])+1];
+            strcpy(country_name, args[0]);
+            virus_name = new char[strlen(args[1])+1];
+            strcpy(virus_name, args[1]);
+
+            if ( !(parseDateString(args[2], start) && parseDateString(args[3], end)) )
+            {
+                delete[] args;
+                printf("Invalid date argument detected. Rejecting command.\n");
+                return false;
+            }
+            delete[] args;
+            if (compareDates(start, end) > 0)
+            {
+                printf("The first Date cannot be greater than the second one. Rejecting command.\n");
+                return false;
+            }
+            return true;
+        default:
+            // This point should never be reached, but
+            // if it does, something really bad has happened :(
+            delete[] args;
+            return false;
+            break;
+    }
+}
+
+/**
+ * Checks if a command that expects no arguments (e.g. /stats) was valid.
+ */
+bool noArgumentsParse()
+{
+    if (strtok(NULL, " ") != NULL)
+    // There are arguments, which is unexpected.
+    {
+        printf("More than expected arguments found. Rejecting command.\n");
+        return false;
+    }
+    return true;
+}
@@ -23,15 +23,17 @@ bool parseDateString(const char *string, Date &date);
  */
 
 bool insertCitizenRecordParse(int &citizen_id, char *&citizen_fullname, char *&country_name,
-                              int &citizen_age, char *&virus_name, bool &vaccinated, Date &date, FILE *fstream);
+                              int &citizen_age, char *&virus_name, bool &vaccinated, Date &date, FILE *fstream,
+                              char **saveptr = NULL);
 
 bool parentCheckParseArgs(int argc, char const *argv[], char *&directory_path, unsigned int &num_monitors,
                     unsigned long &bloom_size, unsigned int &buffer_size, unsigned int &cyclic_buffer_size,
-                    unsigned int &num_threads);
+                    unsigned int &num_threads, int &placement, int &membership);
 
 bool childCheckparseArgs(int argc, char const *argv[], uint16_t &port,
                unsigned int &num_threads, unsigned int &buffer_size, unsigned int &cyclic_buffer_size,
-               DirectoryInfo **&directories, unsigned long &bloom_size, unsigned int &num_dirs);
+               DirectoryInfo **&directories, DirectoryWatcher *&watcher, unsigned long &bloom_size, int &membership,
+               unsigned int &num_dirs);
 
 bool addVaccinationRecordsParse(char *&country_name);
 
@@ -41,4 +43,8 @@ bool travelRequestParse(unsigned int &citizen_id, Date &date, char *&countryFrom
 
 bool travelStatsParse(char *&virus_name, Date &start, Date &end, char *&country_name);
 
+bool populationStatusParse(char *&country_name, char *&virus_name, Date &start, Date &end);
+
+bool noArgumentsParse();
+
 #endif
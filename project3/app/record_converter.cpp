@@ -0,0 +1,119 @@
+/**
+ * File: record_converter.cpp
+ * Converts a text record file to the binary record file format (see record_file.hpp).
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../include/utils.hpp"
+#include "app_utils.hpp"
+#include "parse_utils.hpp"
+#include "record_file.hpp"
+
+/**
+ * Parses the given text record line.
+ * @returns TRUE if the line is a valid record, FALSE otherwise.
+ * The returned strings must be deleted after use (they are set to NULL if FALSE is returned).
+ */
+bool parseRecordLine(const char *line_buf, int &citizen_id, char *&citizen_name, char *&country_name,
+                     int &age, char *&virus_name, bool &vaccinated, Date &date)
+{
+    char *temp = new char[strlen(line_buf) + 3];
+    sprintf(temp, "~ %s", line_buf);            // just a "hack" so that the parsing function
+                                                // can get all the line tokens using strtok.
+    strtok(temp, " ");
+    bool valid = insertCitizenRecordParse(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date, NULL);
+    delete[] temp;
+    if (!valid)
+    {
+        delete[] citizen_name;
+        delete[] country_name;
+        delete[] virus_name;
+        citizen_name = country_name = virus_name = NULL;
+    }
+    return valid;
+}
+
+int main(int argc, char const *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Execution format: ./recordConverter <text_records_file> <binary_records_file>\n");
+        return 1;
+    }
+    FILE *input_file = fopen(argv[1], "r");
+    if (input_file == NULL)
+    {
+        printf("Unable to open the specified input file.\n");
+        return 1;
+    }
+    if (isRecordFile(input_file))
+    {
+        printf("The input file is already a binary record file.\n");
+        fclose(input_file);
+        return 1;
+    }
+    FILE *output_file = fopen(argv[2], "wb");
+    if (output_file == NULL)
+    {
+        printf("Unable to create the specified output file.\n");
+        fclose(input_file);
+        return 1;
+    }
+
+    char *line_buf, *citizen_name, *country_name, *virus_name;
+    int citizen_id, age;
+    bool vaccinated;
+    Date date;
+    RecordDictionary countries, viruses;
+
+    // First pass: create the country & virus dictionaries
+    while( (line_buf = fgetline(input_file)) != NULL)
+    {
+        if (parseRecordLine(line_buf, citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date))
+        {
+            countries.add(country_name);
+            viruses.add(virus_name);
+            delete[] citizen_name;
+            delete[] country_name;
+            delete[] virus_name;
+        }
+        free(line_buf);
+    }
+
+    // Second pass: write the records
+    rewind(input_file);
+    RecordFileWriter writer(output_file, &countries, &viruses);
+    unsigned int converted = 0, rejected = 0;
+    while( (line_buf = fgetline(input_file)) != NULL)
+    {
+        if (parseRecordLine(line_buf, citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date) &&
+            writer.writeRecord(citizen_id, citizen_name, country_name, age, virus_name, vaccinated, date))
+        {
+            converted++;
+        }
+        else
+        {
+            printf("ERROR in record: %s\n", line_buf);
+            rejected++;
+        }
+        delete[] citizen_name;
+        delete[] country_name;
+        delete[] virus_name;
+        free(line_buf);
+    }
+    fclose(input_file);
+
+    bool success = writer.finish();
+    success = (fclose(output_file) == 0) && success;
+    if (!success)
+    {
+        printf("Failed to write the output file.\n");
+        return 1;
+    }
+    printf("Converted %u records (%u rejected).\n", converted, rejected);
+    return 0;
+}
@@ -0,0 +1,351 @@
+/**
+ * File: record_file.cpp
+ * Implementations of classes & routines used for reading/writing Vaccination Records in binary record files.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "../include/linked_list.hpp"
+#include "../include/hash_table.hpp"
+#include "../include/hash_functions.hpp"
+#include "app_utils.hpp"
+#include "record_file.hpp"
+
+/* Little-endian field helpers ---------------------------------------------------------------------- */
+
+static unsigned int loadU16(const unsigned char *bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int loadU32(const unsigned char *bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static void storeU16(unsigned char *bytes, unsigned int value)
+{
+    bytes[0] = value & 0xFF;
+    bytes[1] = (value >> 8) & 0xFF;
+}
+
+static void storeU32(unsigned char *bytes, unsigned int value)
+{
+    storeU16(bytes, value & 0xFFFF);
+    storeU16(bytes + 2, value >> 16);
+}
+
+/**
+ * Returns the packed (16-bit) representation of the given Date.
+ */
+static unsigned int packDate(const Date &date)
+{
+    return (date.year - MIN_YEAR) * DAYS_PER_YEAR + (date.month - 1) * DAYS_PER_MONTH + date.day;
+}
+
+/**
+ * Stores the Date represented by the given packed Date (which must be non-zero) in date.
+ */
+static void unpackDate(unsigned int packed, Date &date)
+{
+    packed--;
+    date.set(packed % DAYS_PER_MONTH + 1, (packed / DAYS_PER_MONTH) % 12 + 1, packed / DAYS_PER_YEAR + MIN_YEAR);
+}
+
+/**
+ * Checks whether the given file is a binary record file (begins with RECORD_FILE_MAGIC).
+ * The file position is restored to the beginning of the file.
+ */
+bool isRecordFile(FILE *file)
+{
+    char magic[RECORD_FILE_MAGIC_SIZE];
+    bool is_record_file = (fread(magic, sizeof(char), RECORD_FILE_MAGIC_SIZE, file) == RECORD_FILE_MAGIC_SIZE) &&
+                          (memcmp(magic, RECORD_FILE_MAGIC, RECORD_FILE_MAGIC_SIZE) == 0);
+    rewind(file);
+    return is_record_file;
+}
+
+/* RecordFileReader methods ------------------------------------------------------------------------- */
+
+/**
+ * Creates a Reader for the given binary record file (which must be at its beginning),
+ * and reads the file header (magic & dictionaries). If the header is invalid, isValid() returns FALSE.
+ */
+RecordFileReader::RecordFileReader(FILE *input):
+file(input), countries(NULL), viruses(NULL), num_countries(0), num_viruses(0), remaining_records(0), valid(false)
+{
+    char magic[RECORD_FILE_MAGIC_SIZE];
+    unsigned char count[4];
+    valid = (fread(magic, sizeof(char), RECORD_FILE_MAGIC_SIZE, file) == RECORD_FILE_MAGIC_SIZE) &&
+            (memcmp(magic, RECORD_FILE_MAGIC, RECORD_FILE_MAGIC_SIZE) == 0) &&
+            readDictionary(countries, num_countries) && readDictionary(viruses, num_viruses) &&
+            (fread(count, sizeof(unsigned char), 4, file) == 4);
+    if (valid)
+    {
+        remaining_records = loadU32(count);
+    }
+}
+
+RecordFileReader::~RecordFileReader()
+{
+    for (unsigned short int i = 0; i < num_countries; i++)
+    {
+        delete[] countries[i];
+    }
+    for (unsigned short int i = 0; i < num_viruses; i++)
+    {
+        delete[] viruses[i];
+    }
+    delete[] countries;
+    delete[] viruses;
+}
+
+/**
+ * Reads a dictionary (a number of strings) from the file.
+ * @returns TRUE if the whole dictionary was read successfully, FALSE otherwise.
+ */
+bool RecordFileReader::readDictionary(char **&dictionary, unsigned short int &size)
+{
+    unsigned char bytes[2];
+    if (fread(bytes, sizeof(unsigned char), 2, file) != 2)
+    {
+        return false;
+    }
+    unsigned short int entries = loadU16(bytes);
+    dictionary = new char*[entries];
+    // size is the number of entries that are actually stored (and will be deleted)
+    for (size = 0; size < entries; size++)
+    {
+        int len = fgetc(file);
+        if (len == EOF)
+        {
+            return false;
+        }
+        dictionary[size] = new char[len + 1];
+        if (fread(dictionary[size], sizeof(char), len, file) != (size_t)len)
+        {
+            delete[] dictionary[size];
+            return false;
+        }
+        dictionary[size][len] = '\0';
+    }
+    return true;
+}
+
+bool RecordFileReader::isValid() const
+{
+    return valid;
+}
+
+/**
+ * @brief Reads the next Vaccination Record of the file.
+ * The returned strings are owned by the Reader, and remain valid until the next record is read.
+ *
+ * @returns TRUE if a record was read successfully, FALSE if there are no more records or the record was invalid.
+ */
+bool RecordFileReader::readRecord(unsigned int &citizen_id, char *&full_name, char *&country_name,
+                                  unsigned short int &age, char *&virus_name, bool &vaccinated, Date &date)
+{
+    unsigned char fixed[RECORD_FILE_FIXED_SIZE];
+    if (!valid || remaining_records == 0 ||
+        fread(fixed, sizeof(unsigned char), RECORD_FILE_FIXED_SIZE, file) != RECORD_FILE_FIXED_SIZE)
+    {
+        return false;
+    }
+    remaining_records--;
+
+    unsigned int country_index = loadU16(fixed + 5);
+    unsigned int virus_index = loadU16(fixed + 7);
+    unsigned int packed_date = loadU16(fixed + 9);
+    unsigned int name_len = fixed[11];
+    if (country_index >= num_countries || virus_index >= num_viruses ||
+        fread(name_buffer, sizeof(char), name_len, file) != name_len)
+    // Invalid record, so stop reading the file
+    {
+        valid = false;
+        return false;
+    }
+    name_buffer[name_len] = '\0';
+
+    citizen_id = loadU32(fixed);
+    age = fixed[4];
+    country_name = countries[country_index];
+    virus_name = viruses[virus_index];
+    full_name = name_buffer;
+    vaccinated = (packed_date != 0);
+    if (vaccinated)
+    {
+        unpackDate(packed_date, date);
+    }
+    else
+    {
+        date.set(0, 0, 0);
+    }
+    return true;
+}
+
+/* RecordDictionary methods ------------------------------------------------------------------------- */
+
+RecordDictionary::DictionaryEntry::DictionaryEntry(const char *entry_name, unsigned int entry_index):
+name(copyString(entry_name)), index(entry_index) { }
+
+RecordDictionary::DictionaryEntry::~DictionaryEntry()
+{
+    delete[] name;
+}
+
+/**
+ * Compares the given name with the name of the given DictionaryEntry.
+ */
+int RecordDictionary::compareNameEntry(void *name, void *entry)
+{
+    return strcmp(static_cast<char*>(name), static_cast<DictionaryEntry*>(entry)->name);
+}
+
+/**
+ * Returns the integer to get the hashcode of, for the specified DictionaryEntry.
+ */
+int RecordDictionary::entryHashObject(void *entry)
+{
+    return djb2((unsigned char*)static_cast<DictionaryEntry*>(entry)->name);
+}
+
+RecordDictionary::RecordDictionary():
+entries(new LinkedList(delete_object<DictionaryEntry>)),
+index(new HashTable(RECORD_DICTIONARY_BUCKETS, NULL, entryHashObject)) { }
+
+RecordDictionary::~RecordDictionary()
+{
+    // The index does not own the entries
+    delete index;
+    delete entries;
+}
+
+/**
+ * Adds the given name at the end of the dictionary (if not already present).
+ * @returns FALSE if the name cannot be stored in a binary record file, TRUE otherwise.
+ */
+bool RecordDictionary::add(const char *name)
+{
+    if (strlen(name) > RECORD_FILE_MAX_STRING)
+    {
+        return false;
+    }
+    if (indexOf(name) < 0)
+    {
+        if (getSize() == RECORD_FILE_MAX_DICTIONARY)
+        {
+            return false;
+        }
+        DictionaryEntry *entry = new DictionaryEntry(name, getSize());
+        entries->append(entry);
+        index->insert(entry);
+    }
+    return true;
+}
+
+/**
+ * Returns the index of the given name in the dictionary, or -1 if it is not present.
+ */
+int RecordDictionary::indexOf(const char *name) const
+{
+    DictionaryEntry *entry = static_cast<DictionaryEntry*>(index->getElement(djb2((unsigned char*)name), (void*)name,
+                                                                             compareNameEntry));
+    return (entry == NULL) ? -1 : (int)entry->index;
+}
+
+/**
+ * Returns the number of names in the dictionary.
+ */
+unsigned int RecordDictionary::getSize() const
+{
+    return entries->getNumElements();
+}
+
+/**
+ * Writes the dictionary (the number of names, followed by the length & bytes of each name) in the given file.
+ */
+void RecordDictionary::write(FILE *file) const
+{
+    unsigned char bytes[2];
+    storeU16(bytes, getSize());
+    fwrite(bytes, sizeof(unsigned char), 2, file);
+    for (LinkedList::ListIterator itr = entries->listHead(); !itr.isNull(); itr.forward())
+    {
+        const char *name = static_cast<DictionaryEntry*>(itr.getData())->name;
+        fputc(strlen(name), file);
+        fwrite(name, sizeof(char), strlen(name), file);
+    }
+}
+
+/* RecordFileWriter methods ------------------------------------------------------------------------- */
+
+/**
+ * @brief Creates a Writer for the given (empty) output file, and writes the file header.
+ *
+ * @param country_names A dictionary with the names of all the countries that will appear in the records.
+ * @param virus_names A dictionary with the names of all the viruses that will appear in the records.
+ */
+RecordFileWriter::RecordFileWriter(FILE *output, const RecordDictionary *country_names,
+                                   const RecordDictionary *virus_names):
+file(output), countries(country_names), viruses(virus_names), count_offset(0), num_records(0)
+{
+    unsigned char bytes[4];
+    fwrite(RECORD_FILE_MAGIC, sizeof(char), RECORD_FILE_MAGIC_SIZE, file);
+    countries->write(file);
+    viruses->write(file);
+    // The number of records is updated in finish()
+    count_offset = ftell(file);
+    storeU32(bytes, 0);
+    fwrite(bytes, sizeof(unsigned char), 4, file);
+}
+
+/**
+ * @brief Writes the specified Vaccination Record in the file.
+ *
+ * @returns TRUE if the record was written, FALSE if it cannot be represented
+ * (unknown country/virus, too long name, age or date out of range).
+ */
+bool RecordFileWriter::writeRecord(unsigned int citizen_id, const char *full_name, const char *country_name,
+                                   unsigned short int age, const char *virus_name, bool vaccinated, const Date &date)
+{
+    int country_index = countries->indexOf(country_name);
+    int virus_index = viruses->indexOf(virus_name);
+    unsigned int name_len = strlen(full_name);
+    if (country_index < 0 || virus_index < 0 || name_len > RECORD_FILE_MAX_STRING || age > 0xFF ||
+        (vaccinated && !date.isValidDate()))
+    {
+        return false;
+    }
+    unsigned char fixed[RECORD_FILE_FIXED_SIZE];
+    storeU32(fixed, citizen_id);
+    fixed[4] = age;
+    storeU16(fixed + 5, country_index);
+    storeU16(fixed + 7, virus_index);
+    storeU16(fixed + 9, vaccinated ? packDate(date) : 0);
+    fixed[11] = name_len;
+    fwrite(fixed, sizeof(unsigned char), RECORD_FILE_FIXED_SIZE, file);
+    fwrite(full_name, sizeof(char), name_len, file);
+    num_records++;
+    return true;
+}
+
+/**
+ * Stores the number of written records in the file header.
+ * @returns TRUE if the file was written successfully, FALSE otherwise.
+ */
+bool RecordFileWriter::finish()
+{
+    unsigned char bytes[4];
+    storeU32(bytes, num_records);
+    long end = ftell(file);
+    if (fseek(file, count_offset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    fwrite(bytes, sizeof(unsigned char), 4, file);
+    fseek(file, end, SEEK_SET);
+    return (ferror(file) == 0);
+}
@@ -0,0 +1,108 @@
+/**
+ * File: record_file.hpp
+ * Classes & routines used for reading/writing Vaccination Records in binary record files.
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * Binary record file format (all numbers are little-endian):
+ *
+ *   RECORD_FILE_MAGIC
+ *   <number of countries (16-bit)> { <name length (8-bit)> <name bytes> }
+ *   <number of viruses (16-bit)>   { <name length (8-bit)> <name bytes> }
+ *   <number of records (32-bit)>
+ *   { <citizen id (32-bit)> <age (8-bit)> <country index (16-bit)> <virus index (16-bit)>
+ *     <packed date (16-bit)> <full name length (8-bit)> <full name bytes> }
+ *
+ * The packed date is 0 for a NO record, otherwise it is the number of days since 1-1-1990
+ * (with 30-day months) plus 1, for a YES record.
+ */
+
+#ifndef RECORD_FILE_HPP
+#define RECORD_FILE_HPP
+
+#include <cstdio>
+
+#define RECORD_FILE_MAGIC "VMRECBIN"        // The first bytes of every binary record file
+#define RECORD_FILE_MAGIC_SIZE 8
+#define RECORD_FILE_MAX_STRING 255          // Maximum length of names stored in binary record files
+#define RECORD_FILE_FIXED_SIZE 12           // Bytes of a record before the full name bytes
+#define RECORD_FILE_MAX_DICTIONARY 65535    // Maximum number of countries/viruses in a binary record file
+#define RECORD_DICTIONARY_BUCKETS 1024      // Number of buckets of the name index of each dictionary
+
+class Date;
+class LinkedList;
+class HashTable;
+
+bool isRecordFile(FILE *file);
+
+/**
+ * Used for reading Vaccination Records from a binary record file.
+ */
+class RecordFileReader
+{
+    private:
+        FILE *file;
+        char **countries;                           // The country dictionary
+        char **viruses;                             // The virus dictionary
+        unsigned short int num_countries;
+        unsigned short int num_viruses;
+        unsigned int remaining_records;             // Number of records not read yet
+        char name_buffer[RECORD_FILE_MAX_STRING + 1];
+        bool valid;                                 // FALSE if the header was invalid
+        bool readDictionary(char **&dictionary, unsigned short int &size);
+    public:
+        RecordFileReader(FILE *input);
+        ~RecordFileReader();
+        bool isValid() const;
+        bool readRecord(unsigned int &citizen_id, char *&full_name, char *&country_name, unsigned short int &age,
+                        char *&virus_name, bool &vaccinated, Date &date);
+};
+
+/**
+ * The names (of countries or viruses) stored in the header of a binary record file, in order.
+ * The names are also indexed in a Hash Table, so that the index of each name is found in constant time.
+ */
+class RecordDictionary
+{
+    private:
+        /**
+         * A name of the dictionary, along with its index.
+         */
+        struct DictionaryEntry
+        {
+            char *name;
+            const unsigned int index;
+            DictionaryEntry(const char *entry_name, unsigned int entry_index);
+            ~DictionaryEntry();
+        };
+        LinkedList *entries;                        // The entries, in index order
+        HashTable *index;                           // The same entries, hashed by name
+        static int compareNameEntry(void *name, void *entry);
+        static int entryHashObject(void *entry);
+    public:
+        RecordDictionary();
+        ~RecordDictionary();
+        bool add(const char *name);
+        int indexOf(const char *name) const;
+        unsigned int getSize() const;
+        void write(FILE *file) const;
+};
+
+/**
+ * Used for writing Vaccination Records in a binary record file.
+ */
+class RecordFileWriter
+{
+    private:
+        FILE *file;
+        const RecordDictionary *countries;          // The country dictionary
+        const RecordDictionary *viruses;            // The virus dictionary
+        long count_offset;                          // The file position of the number of records
+        unsigned int num_records;                   // Number of records written
+    public:
+        RecordFileWriter(FILE *output, const RecordDictionary *country_names, const RecordDictionary *virus_names);
+        bool writeRecord(unsigned int citizen_id, const char *full_name, const char *country_name,
+                         unsigned short int age, const char *virus_name, bool vaccinated, const Date &date);
+        bool finish();
+};
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * File: request_log.cpp
+ * Implementations of routines used by the Parent Monitor for storing the decided Travel Requests
+ * in an append-only log, which is replayed when the Parent starts.
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * The log has the following (binary, host byte order) format:
+ *
+ *   REQUEST_LOG_MAGIC
+ *   { <destination country> <virus name> <day> <month> <year> <accepted> }
+ *
+ * Strings are preceded by their length (as a 16-bit integer), the date fields are 16-bit integers
+ * and the accepted flag is an 8-bit integer (1 for accepted, 0 for rejected requests).
+ * Each entry is flushed as soon as it is written. An incomplete entry at the end of the log
+ * (e.g. if the Parent was killed while writing it) is discarded when the log is opened.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "../include/linked_list.hpp"
+#include "app_utils.hpp"
+#include "parent_monitor_utils.hpp"
+#include "request_log.hpp"
+
+/**
+ * Reads the next entry of the given log.
+ *
+ * @returns TRUE if a complete & valid entry was read, FALSE otherwise.
+ */
+static bool readEntry(FILE *log, char *&country_name, uint16_t &country_size, char *&virus_name, uint16_t &virus_size,
+                      Date &date, bool &accepted)
+{
+    uint16_t date_fields[3];
+    uint8_t accepted_flag;
+    if (!readString(log, country_name, country_size) || !readString(log, virus_name, virus_size) ||
+        fread(date_fields, sizeof(uint16_t), 3, log) != 3 || fread(&accepted_flag, sizeof(uint8_t), 1, log) != 1)
+    {
+        return false;
+    }
+    date.set(date_fields[0], date_fields[1], date_fields[2]);
+    accepted = (accepted_flag == 1);
+    return date.isValidDate() && accepted_flag <= 1;
+}
+
+/**
+ * @brief Opens the Travel Request log with the specified path (it is created if it does not exist),
+ * and replays all of its entries, storing each Travel Request in the VirusRequests of its destination country.
+ * Entries about countries that do not exist in the given array are ignored (but they remain in the log).
+ *
+ * @returns The log file, positioned at its end so that new entries can be appended,
+ * or NULL if the log could not be opened/created or it is not a valid Travel Request log.
+ */
+FILE* openRequestLog(const char *path, CountryMonitor **countries, unsigned int num_countries)
+{
+    FILE *log = fopen(path, "r+b");
+    if (log == NULL)
+    // The log does not exist, so create it
+    {
+        log = fopen(path, "w+b");
+        if (log == NULL)
+        {
+            fprintf(stderr, "Failed to create travel request log: %s\n", path);
+            return NULL;
+        }
+    }
+    char magic[REQUEST_LOG_MAGIC_SIZE];
+    size_t magic_bytes = fread(magic, sizeof(char), REQUEST_LOG_MAGIC_SIZE, log);
+    if (magic_bytes == 0 && feof(log))
+    // Empty log, so just write the magic bytes
+    {
+        rewind(log);
+        fwrite(REQUEST_LOG_MAGIC, sizeof(char), REQUEST_LOG_MAGIC_SIZE, log);
+        fflush(log);
+        return log;
+    }
+    if (magic_bytes != REQUEST_LOG_MAGIC_SIZE || memcmp(magic, REQUEST_LOG_MAGIC, REQUEST_LOG_MAGIC_SIZE) != 0)
+    {
+        fprintf(stderr, "Invalid travel request log: %s\n", path);
+        fclose(log);
+        return NULL;
+    }
+
+    char *country_name = NULL, *virus_name = NULL;
+    uint16_t country_size = 0, virus_size = 0;
+    Date date;
+    bool accepted;
+    // The end of the last complete entry
+    off_t valid_end = ftello(log);
+    while (readEntry(log, country_name, country_size, virus_name, virus_size, date, accepted))
+    {
+        CountryMonitor *country = getCountryMonitor(country_name, countries, num_countries);
+        if (country != NULL)
+        {
+            storeTravelRequest(country, virus_name, date, accepted);
+        }
+        valid_end = ftello(log);
+    }
+    delete[] country_name;
+    delete[] virus_name;
+
+    // Discard anything after the last complete entry, and continue from there
+    if (ftruncate(fileno(log), valid_end) != 0 || fseeko(log, valid_end, SEEK_SET) != 0)
+    {
+        fprintf(stderr, "Failed to recover travel request log: %s\n", path);
+        fclose(log);
+        return NULL;
+    }
+    return log;
+}
+
+/**
+ * Appends an entry for the specified Travel Request in the given log, and flushes it.
+ * @returns TRUE if the entry was written successfully, FALSE otherwise.
+ */
+bool appendRequestLog(FILE *log, const char *country_name, const char *virus_name, const Date &date, bool accepted)
+{
+    uint16_t date_fields[3] = { date.day, date.month, date.year };
+    uint8_t accepted_flag = accepted ? 1 : 0;
+
+    writeString(log, country_name);
+    writeString(log, virus_name);
+    fwrite(date_fields, sizeof(uint16_t), 3, log);
+    fwrite(&accepted_flag, sizeof(uint8_t), 1, log);
+    return (fflush(log) == 0);
+}
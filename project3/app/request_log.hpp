@@ -0,0 +1,23 @@
+/**
+ * File: request_log.hpp
+ * Routines used by the Parent Monitor for storing the decided Travel Requests in an append-only log,
+ * which is replayed when the Parent starts.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#ifndef REQUEST_LOG_HPP
+#define REQUEST_LOG_HPP
+
+#include <cstdio>
+
+#define REQUEST_LOG_MAGIC "VMREQLOG"    // The first bytes of every Travel Request log
+#define REQUEST_LOG_MAGIC_SIZE 8
+
+class CountryMonitor;
+class Date;
+
+FILE* openRequestLog(const char *path, CountryMonitor **countries, unsigned int num_countries);
+
+bool appendRequestLog(FILE *log, const char *country_name, const char *virus_name, const Date &date, bool accepted);
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ * File: snapshot_utils.cpp
+ * Implementations of routines used by the child Monitors for writing/loading snapshots of their records.
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * A snapshot contains the files that have been scanned in each assigned directory (and how many bytes
+ * of each file have been scanned), as well as all the stored Vaccination Records,
+ * in the following (binary, host byte order) format:
+ *
+ *   SNAPSHOT_MAGIC
+ *   <number of directories> { <directory path> <number of files> { <file name> <scanned bytes> } }
+ *   <number of viruses> { <virus name> { 1 <citizen id> <age> <full name> <country> <YES/NO> <date> } 0 }
+ *
+ * Numbers are unsigned 32-bit integers (64-bit for scanned bytes, 16-bit for age & date fields, 8-bit for flags),
+ * and strings are preceded by their length (as a 16-bit integer).
+ * The Bloom Filters & the Country structures are rebuilt while the records are being inserted.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+
+#include "../include/linked_list.hpp"
+#include "../include/skip_list.hpp"
+#include "app_utils.hpp"
+#include "snapshot_utils.hpp"
+
+/**
+ * The scanned part of a file, as stored in a snapshot.
+ */
+struct FileOffset {
+    FileInfo *file;
+    off_t offset;
+
+    FileOffset(FileInfo *f, off_t o) : file(f), offset(o) { }
+};
+
+/**
+ * A Vaccination Record read from a snapshot, kept until the whole snapshot has been read.
+ */
+struct SnapshotRecord {
+    unsigned int citizen_id;
+    unsigned short int age;
+    char *fullname;
+    char *country;
+    char *virus_name;       // Owned by the list of virus names read from the snapshot
+    bool vaccinated;
+    Date date;
+
+    SnapshotRecord(unsigned int id, unsigned short int a, const char *name, const char *country_name, char *virus,
+                   bool is_vaccinated, const Date &d) :
+        citizen_id(id), age(a), fullname(copyString(name)), country(copyString(country_name)), virus_name(virus),
+        vaccinated(is_vaccinated), date(d) { }
+    ~SnapshotRecord() { delete[] fullname; delete[] country; }
+};
+
+/**
+ * Writes the specified Vaccination Record in the given file.
+ */
+static void writeRecord(FILE *file, VaccinationRecord *record)
+{
+    uint8_t flag = 1;
+    uint32_t id = record->citizen->id;
+    uint16_t age = record->citizen->age;
+    uint8_t vaccinated = record->vaccinated ? 1 : 0;
+    uint16_t date[3] = { record->date.day, record->date.month, record->date.year };
+
+    fwrite(&flag, sizeof(uint8_t), 1, file);
+    fwrite(&id, sizeof(uint32_t), 1, file);
+    fwrite(&age, sizeof(uint16_t), 1, file);
+    writeString(file, record->citizen->fullname);
+    writeString(file, record->citizen->country->country_name);
+    fwrite(&vaccinated, sizeof(uint8_t), 1, file);
+    fwrite(date, sizeof(uint16_t), 3, file);
+}
+
+/**
+ * @brief Writes a snapshot of the Monitor records in the file with the specified path.
+ * The snapshot is written in a temporary file first, which then replaces the existing one (if any),
+ * so an existing snapshot is never left incomplete.
+ *
+ * @param path The path of the snapshot file.
+ * @param directories The assigned directories (the files in their contents have been scanned up to their offset).
+ * @param num_dirs The number of assigned directories.
+ * @param viruses The list with the VirusRecords of the Monitor.
+ *
+ * @returns TRUE if the snapshot was written successfully, FALSE otherwise.
+ */
+bool writeSnapshot(const char *path, DirectoryInfo **directories, unsigned short int num_dirs, LinkedList *viruses)
+{
+    std::string temp_path(path);
+    temp_path.append(".tmp");
+    FILE *file = fopen(temp_path.c_str(), "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    fwrite(SNAPSHOT_MAGIC, sizeof(char), SNAPSHOT_MAGIC_SIZE, file);
+
+    // Write the scanned files of each directory
+    uint32_t num = num_dirs;
+    fwrite(&num, sizeof(uint32_t), 1, file);
+    for (unsigned short int i = 0; i < num_dirs; i++)
+    {
+        writeString(file, directories[i]->path);
+        num = directories[i]->contents->getNumElements();
+        fwrite(&num, sizeof(uint32_t), 1, file);
+        for (LinkedList::ListIterator itr = directories[i]->contents->listHead(); !itr.isNull(); itr.forward())
+        {
+            FileInfo *file_info = static_cast<FileInfo*>(itr.getData());
+            int64_t offset = file_info->offset;
+            writeString(file, file_info->name);
+            fwrite(&offset, sizeof(int64_t), 1, file);
+        }
+    }
+
+    // Write the records of each virus
+    num = viruses->getNumElements();
+    fwrite(&num, sizeof(uint32_t), 1, file);
+    for (LinkedList::ListIterator itr = viruses->listHead(); !itr.isNull(); itr.forward())
+    {
+        VirusRecords *virus = static_cast<VirusRecords*>(itr.getData());
+        writeString(file, virus->virus_name);
+        for (SkipList::SkipListIterator rec = virus->getVaccinatedList()->listHead(); !rec.isNull(); rec.forward())
+        {
+            writeRecord(file, static_cast<VaccinationRecord*>(rec.getData()));
+        }
+        for (SkipList::SkipListIterator rec = virus->getNonVaccinatedList()->listHead(); !rec.isNull(); rec.forward())
+        {
+            writeRecord(file, static_cast<VaccinationRecord*>(rec.getData()));
+        }
+        // End of records for this virus
+        uint8_t flag = 0;
+        fwrite(&flag, sizeof(uint8_t), 1, file);
+    }
+
+    bool success = (ferror(file) == 0);
+    success = (fclose(file) == 0) && success;
+    if (!success || rename(temp_path.c_str(), path) != 0)
+    {
+        remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads the snapshot in the file with the specified path, inserting all the records
+ * in the given structures (as if they were read from the scanned files). If the snapshot is loaded successfully,
+ * the offset of each file in the snapshot is restored, so that only the rest of the file will be scanned.
+ * The whole snapshot is read before inserting anything, so nothing is inserted if it is not valid.
+ *
+ * @param path The path of the snapshot file.
+ * @param directories The assigned directories. The snapshot is not loaded if it refers to different directories.
+ * @param num_dirs The number of assigned directories.
+ * @param citizens The Citizen Hash Table of the Monitor.
+ * @param countries The list with the CountryStatus objects of the Monitor.
+ * @param viruses The list with the VirusRecords of the Monitor.
+ * @param bloom_size The size of the Bloom Filters (in bytes).
+ *
+ * @returns TRUE if the snapshot was loaded successfully, FALSE otherwise (the structures are not modified then).
+ */
+bool loadSnapshot(const char *path, DirectoryInfo **directories, unsigned short int num_dirs,
+                  HashTable *citizens, LinkedList *countries, LinkedList *viruses, unsigned long bloom_size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    char magic[SNAPSHOT_MAGIC_SIZE];
+    if (fread(magic, sizeof(char), SNAPSHOT_MAGIC_SIZE, file) != SNAPSHOT_MAGIC_SIZE ||
+        memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    // Strings are read here
+    char *string = NULL, *fullname = NULL, *country = NULL, *virus_name = NULL;
+    uint16_t string_size = 0, fullname_size = 0, country_size = 0, virus_size = 0;
+    // The scanned file offsets & the records are kept here, until the whole snapshot has been read
+    LinkedList offsets(delete_object<FileOffset>);
+    LinkedList records(delete_object<SnapshotRecord>);
+    LinkedList virus_names(delete_object_array<char>);
+    bool success = true;
+
+    // Read the scanned files of each directory
+    uint32_t snapshot_dirs;
+    success = (fread(&snapshot_dirs, sizeof(uint32_t), 1, file) == 1) && (snapshot_dirs == num_dirs);
+    for (uint32_t i = 0; success && i < snapshot_dirs; i++)
+    {
+        uint32_t num_files;
+        success = readString(file, string, string_size) && (strcmp(string, directories[i]->path) == 0) &&
+                  (fread(&num_files, sizeof(uint32_t), 1, file) == 1);
+        for (uint32_t j = 0; success && j < num_files; j++)
+        {
+            int64_t offset;
+            success = readString(file, string, string_size) && (fread(&offset, sizeof(int64_t), 1, file) == 1);
+            FileInfo *file_info = success ? directories[i]->getFile(string) : NULL;
+            if (file_info != NULL && offset <= file_info->size)
+            // The file may have grown since the snapshot was written, so only the rest of it will be scanned
+            {
+                offsets.append(new FileOffset(file_info, offset));
+            }
+        }
+    }
+
+    // Read the records of each virus
+    uint32_t num_viruses;
+    success = success && (fread(&num_viruses, sizeof(uint32_t), 1, file) == 1);
+    for (uint32_t i = 0; success && i < num_viruses; i++)
+    {
+        success = readString(file, virus_name, virus_size);
+        char *stored_name = NULL;
+        if (success)
+        {
+            stored_name = copyString(virus_name);
+            virus_names.append(stored_name);
+        }
+        uint8_t flag;
+        while (success && (success = (fread(&flag, sizeof(uint8_t), 1, file) == 1)) && flag == 1)
+        {
+            uint32_t id;
+            uint16_t age;
+            uint8_t vaccinated;
+            uint16_t date_fields[3];
+            success = (fread(&id, sizeof(uint32_t), 1, file) == 1) &&
+                      (fread(&age, sizeof(uint16_t), 1, file) == 1) &&
+                      readString(file, fullname, fullname_size) &&
+                      readString(file, country, country_size) &&
+                      (fread(&vaccinated, sizeof(uint8_t), 1, file) == 1) &&
+                      (fread(date_fields, sizeof(uint16_t), 3, file) == 3);
+            if (success)
+            {
+                Date date(date_fields[0], date_fields[1], date_fields[2]);
+                records.append(new SnapshotRecord(id, age, fullname, country, stored_name, vaccinated == 1, date));
+            }
+        }
+    }
+    fclose(file);
+    delete[] string;
+    delete[] fullname;
+    delete[] country;
+    delete[] virus_name;
+
+    if (success)
+    // Insert the records and restore the scanned file offsets
+    {
+        for (LinkedList::ListIterator itr = records.listHead(); !itr.isNull(); itr.forward())
+        {
+            SnapshotRecord *record = static_cast<SnapshotRecord*>(itr.getData());
+            insertVaccinationRecord(record->citizen_id, record->fullname, record->country, record->age,
+                                    record->virus_name, record->vaccinated, record->date,
+                                    countries, viruses, citizens, bloom_size, NULL);
+        }
+        for (LinkedList::ListIterator itr = offsets.listHead(); !itr.isNull(); itr.forward())
+        {
+            FileOffset *file_offset = static_cast<FileOffset*>(itr.getData());
+            file_offset->file->offset = file_offset->offset;
+        }
+    }
+    return success;
+}
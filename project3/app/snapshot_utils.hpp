@@ -0,0 +1,22 @@
+/**
+ * File: snapshot_utils.hpp
+ * Routines used by the child Monitors for writing/loading snapshots of their records.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#ifndef SNAPSHOT_UTILS_HPP
+#define SNAPSHOT_UTILS_HPP
+
+#define SNAPSHOT_MAGIC "VMSNAP03"       // The first bytes of every snapshot file
+#define SNAPSHOT_MAGIC_SIZE 8
+
+class DirectoryInfo;
+class HashTable;
+class LinkedList;
+
+bool writeSnapshot(const char *path, DirectoryInfo **directories, unsigned short int num_dirs, LinkedList *viruses);
+
+bool loadSnapshot(const char *path, DirectoryInfo **directories, unsigned short int num_dirs,
+                  HashTable *citizens, LinkedList *countries, LinkedList *viruses, unsigned long bloom_size);
+
+#endif
@@ -0,0 +1,361 @@
+/**
+ * File: adt_bench.cpp
+ * Microbenchmarks for the ADT's in lib/ (Bloom Filter, Hash Table, Linked List, Skip List, Fenwick Tree).
+ * Every insert/find/remove operation is timed individually, and the throughput as well as
+ * the p50/p99/p999 latencies are reported for each ADT, operation, key distribution & number of elements.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+
+#include "../include/bloom_filter.hpp"
+#include "../include/hash_table.hpp"
+#include "../include/linked_list.hpp"
+#include "../include/skip_list.hpp"
+#include "../include/fenwick_tree.hpp"
+#include "../include/utils.hpp"
+
+#define MIN_ELEMENTS 10000              // The first (smallest) number of elements to benchmark
+#define DEFAULT_MAX_ELEMENTS 1000000    // The number of elements is multiplied by 10 up to this (use -n for up to 10M)
+#define MAX_ELEMENTS 10000000
+#define LIST_MAX_FINDS 1000             // Linked List search is linear, so only this many searches are timed
+#define BLOOM_BITS_PER_ELEMENT 10       // The Bloom Filter size, relative to the number of elements
+#define KEY_STRING_SIZE 12              // Bloom Filter keys are the decimal strings of the integer keys
+
+enum Distribution { SEQUENTIAL, RANDOM, SKEWED };
+
+const char *distribution_names[] = { "seq", "random", "skewed" };
+
+/**
+ * A simple xorshift PRNG, so that the generated keys only depend on the given seed.
+ */
+class KeyGenerator
+{
+        unsigned long long state;
+    public:
+        KeyGenerator(unsigned long long seed): state(seed ? seed : 1) { }
+        unsigned long long next()
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+        double nextUniform()
+        {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+};
+
+/**
+ * Stores the latency of each timed operation, and reports the throughput & latency percentiles.
+ */
+class OperationTimer
+{
+        unsigned long long *latencies;      // The latency of each operation (in nanoseconds)
+        unsigned int num_operations;
+        struct timespec start_time;
+    public:
+        OperationTimer(unsigned int max_operations):
+        latencies(new unsigned long long[max_operations]), num_operations(0) { }
+        ~OperationTimer() { delete[] latencies; }
+        void start() { clock_gettime(CLOCK_MONOTONIC, &start_time); }
+        void stop()
+        {
+            struct timespec end_time;
+            clock_gettime(CLOCK_MONOTONIC, &end_time);
+            latencies[num_operations++] = (end_time.tv_sec - start_time.tv_sec) * 1000000000ULL
+                                          + end_time.tv_nsec - start_time.tv_nsec;
+        }
+        void report(const char *adt, const char *operation, Distribution distribution, unsigned int num_elements);
+};
+
+/**
+ * Compares two latencies (to be used by qsort).
+ */
+static int compareLatencies(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Prints a line with the throughput and the latency percentiles of the timed operations,
+ * and resets the timer. The throughput only counts the time spent in the operations.
+ */
+void OperationTimer::report(const char *adt, const char *operation, Distribution distribution, unsigned int num_elements)
+{
+    if (num_operations == 0) { return; }
+    unsigned long long total = 0;
+    for (unsigned int i = 0; i < num_operations; i++)
+    {
+        total += latencies[i];
+    }
+    qsort(latencies, num_operations, sizeof(unsigned long long), compareLatencies);
+    printf("%-8s %-7s %-7s %9u %9u %10.3f %8llu %8llu %8llu\n", adt, operation, distribution_names[distribution],
+           num_elements, num_operations, (total == 0) ? 0 : num_operations * 1000.0 / total,
+           latencies[num_operations / 2], latencies[(unsigned long long)num_operations * 99 / 100],
+           latencies[(unsigned long long)num_operations * 999 / 1000]);
+    num_operations = 0;
+}
+
+/**
+ * Fills keys with n keys in [0, n) of the specified distribution:
+ * 0, 1, ..., n-1 (SEQUENTIAL), a random permutation (RANDOM),
+ * or Zipf-like keys, where small keys are much more frequent than large ones (SKEWED).
+ */
+void generateKeys(int *keys, unsigned int n, Distribution distribution, KeyGenerator &generator)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        keys[i] = i;
+    }
+    if (distribution == RANDOM)
+    {
+        for (unsigned int i = n - 1; i > 0; i--)
+        {
+            unsigned int j = generator.next() % (i + 1);
+            int temp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = temp;
+        }
+    }
+    else if (distribution == SKEWED)
+    // log-uniform keys: the probability of each key is roughly proportional to 1 / (key + 1)
+    {
+        for (unsigned int i = 0; i < n; i++)
+        {
+            keys[i] = (int)pow((double)n, generator.nextUniform()) - 1;
+        }
+    }
+}
+
+/* ADT helper functions ------------------------------------------------------------------------ */
+
+int compareInts(void *a, void *b)
+{
+    return *(int*)a - *(int*)b;
+}
+
+int intHashObject(void *element)
+{
+    return *(int*)element;
+}
+
+void destroyNothing(void *element) { }
+
+/* Benchmarks ---------------------------------------------------------------------------------- */
+
+void benchBloomFilter(int *keys, int *probes, unsigned int n, Distribution distribution, OperationTimer &timer)
+{
+    BloomFilter filter((unsigned long)n * BLOOM_BITS_PER_ELEMENT / 8 + 1);
+    char key_string[KEY_STRING_SIZE];
+    for (unsigned int i = 0; i < n; i++)
+    {
+        sprintf(key_string, "%d", keys[i]);
+        timer.start();
+        filter.markAsPresent(key_string);
+        timer.stop();
+    }
+    timer.report("bloom", "insert", distribution, n);
+    unsigned int present = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        sprintf(key_string, "%d", probes[i]);
+        timer.start();
+        present += filter.isPresent(key_string);
+        timer.stop();
+    }
+    timer.report("bloom", "find", distribution, n);
+}
+
+void benchHashTable(int *keys, int *probes, unsigned int n, Distribution distribution, OperationTimer &timer)
+{
+    HashTable table(n, destroyNothing, intHashObject);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        table.insert(&keys[i]);
+        timer.stop();
+    }
+    timer.report("hash", "insert", distribution, n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        table.getElement(&probes[i], compareInts);
+        timer.stop();
+    }
+    timer.report("hash", "find", distribution, n);
+}
+
+void benchLinkedList(int *keys, int *probes, unsigned int n, Distribution distribution, OperationTimer &timer)
+{
+    LinkedList list(destroyNothing);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        list.append(&keys[i]);
+        timer.stop();
+    }
+    timer.report("list", "insert", distribution, n);
+    for (unsigned int i = 0; i < n && i < LIST_MAX_FINDS; i++)
+    {
+        timer.start();
+        list.getElement(&probes[i], compareInts);
+        timer.stop();
+    }
+    timer.report("list", "find", distribution, n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        list.popFirst();
+        timer.stop();
+    }
+    timer.report("list", "remove", distribution, n);
+}
+
+void benchSkipList(int *keys, int *probes, unsigned int n, Distribution distribution, OperationTimer &timer,
+                   unsigned long long seed)
+{
+    SkipList list(SKIP_LIST_MAX_LAYERS, destroyNothing, seed);
+    void *present;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        list.insert(&keys[i], &present, compareInts);
+        timer.stop();
+    }
+    timer.report("skiplist", "insert", distribution, n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        list.find(&probes[i], compareInts);
+        timer.stop();
+    }
+    timer.report("skiplist", "find", distribution, n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        list.remove(&probes[i], &present, compareInts);
+        timer.stop();
+    }
+    timer.report("skiplist", "remove", distribution, n);
+}
+
+void benchFenwickTree(int *keys, int *probes, unsigned int n, Distribution distribution, OperationTimer &timer)
+{
+    FenwickTree tree(n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        tree.add(keys[i], 1);
+        timer.stop();
+    }
+    timer.report("fenwick", "insert", distribution, n);
+    unsigned long long sum = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        sum += tree.prefixSum(probes[i]);
+        timer.stop();
+    }
+    timer.report("fenwick", "find", distribution, n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        timer.start();
+        tree.add(keys[i], -1);
+        timer.stop();
+    }
+    timer.report("fenwick", "remove", distribution, n);
+}
+
+/**
+ * Checks and stores the program arguments.
+ * @returns TRUE if the arguments are valid, FALSE otherwise.
+ */
+bool checkParseArgs(int argc, char const *argv[], unsigned int &max_elements, const char *&adt,
+                    int &distribution, unsigned long long &seed)
+{
+    max_elements = DEFAULT_MAX_ELEMENTS;
+    adt = "all";
+    distribution = -1;
+    seed = 1;
+    if (argc % 2 == 0) { return false; }
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            max_elements = strtoul(argv[i + 1], NULL, 10);
+            if (max_elements < MIN_ELEMENTS || max_elements > MAX_ELEMENTS) { return false; }
+        }
+        else if (strcmp(argv[i], "-a") == 0)
+        {
+            adt = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-d") == 0)
+        {
+            for (distribution = SKEWED; distribution >= SEQUENTIAL; distribution--)
+            {
+                if (strcmp(argv[i + 1], distribution_names[distribution]) == 0) { break; }
+            }
+            if (distribution < SEQUENTIAL) { return false; }
+        }
+        else if (strcmp(argv[i], "-s") == 0)
+        {
+            seed = strtoull(argv[i + 1], NULL, 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char const *argv[])
+{
+    unsigned int max_elements;
+    const char *adt;
+    int selected_distribution;
+    unsigned long long seed;
+    if (!checkParseArgs(argc, argv, max_elements, adt, selected_distribution, seed))
+    {
+        printf("Execution format: ./adtBench [-n <maxElements (%d-%d)>] [-a bloom|hash|list|skiplist|fenwick|all]"
+               " [-d seq|random|skewed] [-s <seed>]\n", MIN_ELEMENTS, MAX_ELEMENTS);
+        return 1;
+    }
+    KeyGenerator generator(seed);
+    int *keys = new int[max_elements];
+    int *probes = new int[max_elements];
+    OperationTimer timer(max_elements);
+
+    printf("%-8s %-7s %-7s %9s %9s %10s %8s %8s %8s\n", "adt", "op", "keys", "elements", "ops", "Mops/s",
+           "p50(ns)", "p99(ns)", "p999(ns)");
+    for (unsigned int n = MIN_ELEMENTS; n <= max_elements; n *= 10)
+    {
+        for (int d = SEQUENTIAL; d <= SKEWED; d++)
+        {
+            if (selected_distribution != -1 && selected_distribution != d) { continue; }
+            Distribution distribution = (Distribution)d;
+            // The inserted keys, and the (different, unless sequential) keys to search for
+            generateKeys(keys, n, distribution, generator);
+            generateKeys(probes, n, distribution, generator);
+
+            bool all = (strcmp(adt, "all") == 0);
+            if (all || strcmp(adt, "bloom") == 0) { benchBloomFilter(keys, probes, n, distribution, timer); }
+            if (all || strcmp(adt, "hash") == 0) { benchHashTable(keys, probes, n, distribution, timer); }
+            if (all || strcmp(adt, "list") == 0) { benchLinkedList(keys, probes, n, distribution, timer); }
+            if (all || strcmp(adt, "skiplist") == 0) { benchSkipList(keys, probes, n, distribution, timer, seed); }
+            if (all || strcmp(adt, "fenwick") == 0) { benchFenwickTree(keys, probes, n, distribution, timer); }
+        }
+        if (n > max_elements / 10) { break; }
+    }
+    delete[] keys;
+    delete[] probes;
+    return 0;
+}
@@ -0,0 +1,343 @@
+/**
+ * File: load_driver.cpp
+ * Spawns travelMonitorClient on localhost, replays a mix of /travelRequest, /searchVaccinationStatus & /travelStats
+ * commands at the specified rate, and reports the throughput and the p50/p99/p999 latencies of the commands.
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * A command is complete when travelMonitorClient prints the separator line that precedes the next command.
+ * travelMonitorClient serves one command at a time, so when a command is sent later than scheduled
+ * (because the previous one took too long), its latency is measured from its scheduled time.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <csignal>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/wait.h>
+
+#include "../include/linked_list.hpp"
+#include "../include/utils.hpp"
+
+#define CLIENT_EXEC_PATH "./travelMonitorClient"
+#define COMMAND_SEPARATOR "------------------------------------------"
+#define MAX_SAMPLE_RECORDS 100000       // Citizen IDs & viruses of up to this many records are used in the commands
+#define MAX_LINE_SIZE 4096
+#define MIN_YEAR 2000                   // The Dates in the commands are between 1-1-MIN_YEAR and 30-12-MAX_YEAR
+#define MAX_YEAR 2021
+
+/**
+ * The citizen ID & virus of a record found in the input directory.
+ */
+struct SampleRecord
+{
+    unsigned int citizen_id;
+    const char *virus_name;
+};
+
+/**
+ * The countries, viruses & records used to create the commands.
+ */
+class Workload
+{
+    public:
+        LinkedList *countries;          // Country names (the input directory subdirectories)
+        LinkedList *viruses;            // Virus names found in the records
+        SampleRecord *records;
+        unsigned int num_records;
+        Workload(): countries(new LinkedList(delete_object_array<char>)), viruses(new LinkedList(delete_object_array<char>)),
+                    records(new SampleRecord[MAX_SAMPLE_RECORDS]), num_records(0) { }
+        ~Workload() { delete countries; delete viruses; delete[] records; }
+        bool load(const char *input_dir);
+        const char* getCountry(unsigned int index) const;
+};
+
+static char* copyName(const char *name)
+{
+    char *copy = new char[strlen(name) + 1];
+    strcpy(copy, name);
+    return copy;
+}
+
+static int compareNames(void *a, void *b)
+{
+    return strcmp((char*)a, (char*)b);
+}
+
+/**
+ * Stores the country directories of the input directory, as well as the citizen IDs & viruses
+ * of (up to MAX_SAMPLE_RECORDS) text records in their files.
+ * @returns TRUE if at least one country & one record were found, FALSE otherwise.
+ */
+bool Workload::load(const char *input_dir)
+{
+    DIR *dir = opendir(input_dir);
+    if (dir == NULL) { return false; }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] == '.') { continue; }
+        countries->append(copyName(entry->d_name));
+    }
+    closedir(dir);
+
+    char path[MAX_LINE_SIZE], line[MAX_LINE_SIZE], virus_name[MAX_LINE_SIZE];
+    for (LinkedList::ListIterator itr = countries->listHead(); !itr.isNull(); itr.forward())
+    {
+        snprintf(path, sizeof(path), "%s/%s", input_dir, (char*)itr.getData());
+        DIR *country_dir = opendir(path);
+        if (country_dir == NULL) { continue; }
+        while ((entry = readdir(country_dir)) != NULL && num_records < MAX_SAMPLE_RECORDS)
+        {
+            if (entry->d_name[0] == '.') { continue; }
+            snprintf(path, sizeof(path), "%s/%s/%s", input_dir, (char*)itr.getData(), entry->d_name);
+            FILE *file = fopen(path, "r");
+            if (file == NULL) { continue; }
+            unsigned int citizen_id;
+            while (num_records < MAX_SAMPLE_RECORDS && fgets(line, sizeof(line), file) != NULL)
+            {
+                // <id> <name> <surname> <country> <age> <virus> ...
+                if (sscanf(line, "%u %*s %*s %*s %*u %s", &citizen_id, virus_name) != 2) { continue; }
+                char *virus = static_cast<char*>(viruses->getElement(virus_name, compareNames));
+                if (virus == NULL)
+                {
+                    viruses->append(copyName(virus_name));
+                    virus = static_cast<char*>(viruses->getLast());
+                }
+                records[num_records].citizen_id = citizen_id;
+                records[num_records].virus_name = virus;
+                num_records++;
+            }
+            fclose(file);
+        }
+        closedir(country_dir);
+    }
+    return !countries->isEmpty() && num_records > 0;
+}
+
+const char* Workload::getCountry(unsigned int index) const
+{
+    LinkedList::ListIterator itr = countries->listHead();
+    for (unsigned int i = 0; i < index; i++)
+    {
+        itr.forward();
+    }
+    return static_cast<const char*>(itr.getData());
+}
+
+static unsigned long long nowNanos()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static int compareLatencies(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Stores a random (valid) Date string in date.
+ */
+static void randomDate(char *date)
+{
+    sprintf(date, "%d-%d-%d", 1 + rand() % 30, 1 + rand() % 12, MIN_YEAR + rand() % (MAX_YEAR - MIN_YEAR + 1));
+}
+
+/**
+ * Stores a random command in command, according to the given percentages. type is set to the command index
+ * (0 for /travelRequest, 1 for /searchVaccinationStatus, 2 for /travelStats).
+ */
+static void createCommand(const Workload &workload, const unsigned int *mix, char *command, int &type)
+{
+    const SampleRecord &record = workload.records[rand() % workload.num_records];
+    unsigned int num_countries = workload.countries->getNumElements();
+    char date[16], end_date[16];
+    unsigned int selection = rand() % 100;
+    randomDate(date);
+    if (selection < mix[0])
+    {
+        type = 0;
+        sprintf(command, "/travelRequest %u %s %s %s %s\n", record.citizen_id, date,
+                workload.getCountry(rand() % num_countries), workload.getCountry(rand() % num_countries), record.virus_name);
+    }
+    else if (selection < mix[0] + mix[1])
+    {
+        type = 1;
+        sprintf(command, "/searchVaccinationStatus %u\n", record.citizen_id);
+    }
+    else
+    {
+        type = 2;
+        sprintf(end_date, "30-12-%d", MAX_YEAR);
+        sprintf(command, "/travelStats %s 1-1-%d %s %s\n", record.virus_name, MIN_YEAR, end_date,
+                (rand() % 2) ? workload.getCountry(rand() % num_countries) : "");
+    }
+}
+
+/**
+ * Reads the output of travelMonitorClient until the next command separator line.
+ * @returns FALSE if travelMonitorClient exited, TRUE otherwise.
+ */
+static bool waitForSeparator(FILE *output)
+{
+    char line[MAX_LINE_SIZE];
+    while (fgets(line, sizeof(line), output) != NULL)
+    {
+        if (strncmp(line, COMMAND_SEPARATOR, strlen(COMMAND_SEPARATOR)) == 0) { return true; }
+    }
+    return false;
+}
+
+/**
+ * Spawns travelMonitorClient with the given arguments, connected to the given pipes.
+ * @returns The process ID, or -1 if fork() failed.
+ */
+static pid_t spawnClient(char **argv, int *input_pipe, int *output_pipe)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        dup2(input_pipe[0], STDIN_FILENO);
+        dup2(output_pipe[1], STDOUT_FILENO);
+        close(input_pipe[1]);
+        close(output_pipe[0]);
+        execv(CLIENT_EXEC_PATH, argv);
+        perror("execv");
+        exit(EXIT_FAILURE);
+    }
+    close(input_pipe[0]);
+    close(output_pipe[1]);
+    return pid;
+}
+
+int main(int argc, char const *argv[])
+{
+    const char *usage = "Execution format: ./loadDriver -i <input_dir> [-n <numRequests>] [-r <requests/sec, 0 for no limit>]"
+                        " [-x <travelRequest %>,<searchVaccinationStatus %>,<travelStats %>] [-m <numMonitors>] [-t <numThreads>]"
+                        " [-s <seed>]\n";
+    const char *input_dir = NULL, *num_monitors = "4", *num_threads = "4";
+    unsigned int num_requests = 1000, rate = 0, seed = 1;
+    unsigned int mix[3] = { 60, 30, 10 };
+    if (argc % 2 == 0)
+    {
+        printf("%s", usage);
+        return 1;
+    }
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-i") == 0) { input_dir = argv[i + 1]; }
+        else if (strcmp(argv[i], "-n") == 0) { num_requests = strtoul(argv[i + 1], NULL, 10); }
+        else if (strcmp(argv[i], "-r") == 0) { rate = strtoul(argv[i + 1], NULL, 10); }
+        else if (strcmp(argv[i], "-m") == 0) { num_monitors = argv[i + 1]; }
+        else if (strcmp(argv[i], "-t") == 0) { num_threads = argv[i + 1]; }
+        else if (strcmp(argv[i], "-s") == 0) { seed = strtoul(argv[i + 1], NULL, 10); }
+        else if (strcmp(argv[i], "-x") == 0)
+        {
+            if (sscanf(argv[i + 1], "%u,%u,%u", &mix[0], &mix[1], &mix[2]) != 3 || mix[0] + mix[1] + mix[2] != 100)
+            {
+                printf("The command percentages must add up to 100.\n");
+                return 1;
+            }
+        }
+        else
+        {
+            printf("%s", usage);
+            return 1;
+        }
+    }
+    Workload workload;
+    if (input_dir == NULL || num_requests == 0 || !workload.load(input_dir))
+    {
+        printf("%s", usage);
+        printf("The input directory must contain country directories with text record files.\n");
+        return 1;
+    }
+    srand(seed);
+
+    // Start travelMonitorClient and wait until it is in command line mode
+    char *client_argv[] = { (char*)CLIENT_EXEC_PATH, (char*)"-m", (char*)num_monitors, (char*)"-b", (char*)"4096",
+                            (char*)"-c", (char*)"16", (char*)"-s", (char*)"100000", (char*)"-i", (char*)input_dir,
+                            (char*)"-t", (char*)num_threads, NULL };
+    int input_pipe[2], output_pipe[2];
+    if (pipe(input_pipe) != 0 || pipe(output_pipe) != 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    unsigned long long startup_time = nowNanos();
+    pid_t client_pid = spawnClient(client_argv, input_pipe, output_pipe);
+    FILE *client_input = fdopen(input_pipe[1], "w");
+    FILE *client_output = fdopen(output_pipe[0], "r");
+    if (client_pid == -1 || !waitForSeparator(client_output))
+    {
+        printf("Failed to start %s.\n", CLIENT_EXEC_PATH);
+        return 1;
+    }
+    printf("travelMonitorClient ready in %.1f ms\n", (nowNanos() - startup_time) / 1e6);
+
+    const char *command_names[3] = { "/travelRequest", "/searchVaccinationStatus", "/travelStats" };
+    unsigned long long *latencies = new unsigned long long[num_requests];
+    unsigned long long *command_latencies[3];
+    unsigned int command_counts[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++)
+    {
+        command_latencies[i] = new unsigned long long[num_requests];
+    }
+    char command[MAX_LINE_SIZE];
+    unsigned int completed = 0;
+    unsigned long long start_time = nowNanos();
+    for (; completed < num_requests; completed++)
+    {
+        // The time this command is scheduled to be sent
+        unsigned long long scheduled = (rate == 0) ? nowNanos() : start_time + completed * 1000000000ULL / rate;
+        unsigned long long now = nowNanos();
+        if (now < scheduled)
+        {
+            struct timespec delay = { (time_t)((scheduled - now) / 1000000000ULL), (long)((scheduled - now) % 1000000000ULL) };
+            nanosleep(&delay, NULL);
+        }
+        int type;
+        createCommand(workload, mix, command, type);
+        fputs(command, client_input);
+        fflush(client_input);
+        if (!waitForSeparator(client_output))
+        {
+            printf("travelMonitorClient exited unexpectedly.\n");
+            break;
+        }
+        latencies[completed] = nowNanos() - scheduled;
+        command_latencies[type][command_counts[type]++] = latencies[completed];
+    }
+    unsigned long long elapsed = nowNanos() - start_time;
+    fputs("/exit\n", client_input);
+    fclose(client_input);
+    while (waitForSeparator(client_output)) { }
+    fclose(client_output);
+    waitpid(client_pid, NULL, 0);
+
+    // Report the results
+    printf("%u requests in %.3f s: %.1f requests/s\n", completed, elapsed / 1e9, completed * 1e9 / elapsed);
+    printf("%-26s %8s %10s %10s %10s\n", "command", "count", "p50(us)", "p99(us)", "p999(us)");
+    for (int i = -1; i < 3; i++)
+    {
+        unsigned long long *values = (i == -1) ? latencies : command_latencies[i];
+        unsigned int count = (i == -1) ? completed : command_counts[i];
+        if (count == 0) { continue; }
+        qsort(values, count, sizeof(unsigned long long), compareLatencies);
+        printf("%-26s %8u %10.1f %10.1f %10.1f\n", (i == -1) ? "all" : command_names[i], count, values[count / 2] / 1e3,
+               values[(unsigned long long)count * 99 / 100] / 1e3, values[(unsigned long long)count * 999 / 1000] / 1e3);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        delete[] command_latencies[i];
+    }
+    delete[] latencies;
+    return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * File: record_generator.cpp
+ * Generates text Vaccination Records for the specified countries & viruses, and writes them directly
+ * in the country directory layout expected by travelMonitorClient (<output dir>/<Country>/<Country>-<i>.txt).
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * Every (citizen, virus) pair is used by at most one "new" record, and the details of each citizen
+ * (name, country, age) only depend on the citizen ID, so the generated records are consistent,
+ * except for the requested percentages of:
+ * - duplicate records: exact copies of an already generated record,
+ * - conflicting records: records of an already used (citizen, virus) pair, with different citizen details.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sys/stat.h>
+
+#include "../include/linked_list.hpp"
+#include "../include/utils.hpp"
+
+#define MAX_CITIZENS 100000         // Citizen IDs must have up to MAX_ID_DIGITS (5) digits
+#define MAX_FILES_PER_COUNTRY 1000
+#define MIN_VACCINATION_YEAR 2000   // Vaccination dates are between 1-1-2000 and 30-12-2021
+#define VACCINATION_YEARS 22
+#define MAX_NAME_LETTERS 12
+
+/**
+ * Returns a pseudo-random number that only depends on x (splitmix64 finalizer).
+ */
+static unsigned long long mix(unsigned long long x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static unsigned long long gcd(unsigned long long a, unsigned long long b)
+{
+    while (b != 0)
+    {
+        unsigned long long temp = a % b;
+        a = b;
+        b = temp;
+    }
+    return a;
+}
+
+/**
+ * Reads the (non-empty) lines of the specified file in a new array.
+ * @returns The array of lines (NULL if the file could not be read). num_lines is set to the number of lines.
+ */
+char** readLines(const char *path, unsigned int &num_lines)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) { return NULL; }
+    LinkedList lines(NULL);
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') { continue; }
+        char *copy = new char[strlen(line) + 1];
+        strcpy(copy, line);
+        lines.append(copy);
+    }
+    fclose(file);
+    num_lines = lines.getNumElements();
+    char **array = new char*[num_lines];
+    unsigned int i = 0;
+    for (LinkedList::ListIterator itr = lines.listHead(); !itr.isNull(); itr.forward())
+    {
+        array[i++] = static_cast<char*>(itr.getData());
+    }
+    return array;
+}
+
+/**
+ * Stores a name with 2-MAX_NAME_LETTERS letters (the first one capital) in name, based on the given seed.
+ */
+static void generateName(unsigned long long seed, char *name)
+{
+    unsigned int len = 2 + seed % (MAX_NAME_LETTERS - 1);
+    seed = mix(seed);
+    name[0] = 'A' + seed % 26;
+    for (unsigned int i = 1; i < len; i++)
+    {
+        seed = mix(seed);
+        name[i] = 'a' + seed % 26;
+    }
+    name[len] = '\0';
+}
+
+/**
+ * Generates the records & writes them in the country directories.
+ */
+class RecordGenerator
+{
+        char **countries, **viruses;
+        unsigned int num_countries, num_viruses;
+        unsigned long long num_citizens;
+        unsigned long long num_pairs;       // num_citizens * num_viruses
+        unsigned long long step;            // Co-prime to num_pairs, so that i * step visits every pair once
+        unsigned long long seed;
+        unsigned long long used_pairs;      // The number of pairs used by new records so far
+        FILE **files;                       // The currently open file of each country
+        void writeRecord(unsigned long long pair, bool conflicting);
+    public:
+        RecordGenerator(char **country_names, unsigned int countries_num, char **virus_names, unsigned int viruses_num,
+                        unsigned long long records, unsigned long long generator_seed);
+        ~RecordGenerator();
+        bool openFiles(const char *output_dir, unsigned int file_number);
+        void closeFiles();
+        void generate(unsigned long long first, unsigned long long last, unsigned int duplicate_rate, unsigned int conflict_rate);
+        unsigned long long maxDistinctRecords() const { return num_pairs; }
+};
+
+RecordGenerator::RecordGenerator(char **country_names, unsigned int countries_num, char **virus_names, unsigned int viruses_num,
+                                 unsigned long long records, unsigned long long generator_seed):
+countries(country_names), viruses(virus_names), num_countries(countries_num), num_viruses(viruses_num),
+num_citizens((records < MAX_CITIZENS) ? ((records > 0) ? records : 1) : MAX_CITIZENS),
+num_pairs(num_citizens * num_viruses), seed(generator_seed), used_pairs(0), files(new FILE*[countries_num])
+{
+    // Start from ~0.618 * num_pairs, so that consecutive records refer to unrelated pairs
+    step = (num_pairs * 618034) / 1000000 + 1;
+    while (gcd(step, num_pairs) != 1)
+    {
+        step++;
+    }
+    for (unsigned int i = 0; i < num_countries; i++)
+    {
+        files[i] = NULL;
+    }
+}
+
+RecordGenerator::~RecordGenerator()
+{
+    closeFiles();
+    delete[] files;
+}
+
+/**
+ * Opens (creates) the file with the specified number in every country directory.
+ * @returns TRUE if all the files were created successfully, FALSE otherwise.
+ */
+bool RecordGenerator::openFiles(const char *output_dir, unsigned int file_number)
+{
+    char path[4096];
+    for (unsigned int i = 0; i < num_countries; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", output_dir, countries[i]);
+        if (mkdir(path, 0755) != 0 && errno != EEXIST)
+        {
+            perror(path);
+            return false;
+        }
+        snprintf(path, sizeof(path), "%s/%s/%s-%u.txt", output_dir, countries[i], countries[i], file_number);
+        if ((files[i] = fopen(path, "w")) == NULL)
+        {
+            perror(path);
+            return false;
+        }
+    }
+    return true;
+}
+
+void RecordGenerator::closeFiles()
+{
+    for (unsigned int i = 0; i < num_countries; i++)
+    {
+        if (files[i] != NULL)
+        {
+            fclose(files[i]);
+            files[i] = NULL;
+        }
+    }
+}
+
+/**
+ * Writes the record of the specified (citizen, virus) pair in the file of the citizen country.
+ * If conflicting is TRUE, the citizen details are different from those of the citizen ID.
+ */
+void RecordGenerator::writeRecord(unsigned long long pair, bool conflicting)
+{
+    unsigned long long citizen_id = pair % num_citizens;
+    unsigned int virus = pair / num_citizens;
+    unsigned long long citizen_seed = mix(seed ^ (citizen_id * 2 + conflicting));
+    unsigned long long record_seed = mix(mix(seed) ^ pair);
+    char name[MAX_NAME_LETTERS + 1], surname[MAX_NAME_LETTERS + 1];
+    generateName(citizen_seed, name);
+    generateName(mix(citizen_seed + 3), surname);
+    unsigned int country = mix(citizen_seed + 1) % num_countries;
+    unsigned int age = 1 + mix(citizen_seed + 2) % 120;
+
+    FILE *file = files[country];
+    fprintf(file, "%llu %s %s %s %u %s ", citizen_id, name, surname, countries[country], age, viruses[virus]);
+    if (record_seed % 2 == 0)
+    {
+        record_seed = mix(record_seed);
+        fprintf(file, "YES %u-%u-%u\n", 1 + (unsigned int)(record_seed % 30), 1 + (unsigned int)(record_seed / 30 % 12),
+                MIN_VACCINATION_YEAR + (unsigned int)(record_seed / 360 % VACCINATION_YEARS));
+    }
+    else
+    {
+        fprintf(file, "NO\n");
+    }
+}
+
+/**
+ * Generates the records with indices in [first, last) (to be called for consecutive ranges).
+ * Each record is a duplicate with probability duplicate_rate %, a conflicting record with probability
+ * conflict_rate %, and the record of a new (citizen, virus) pair otherwise.
+ * Once every pair has been used, only duplicates are generated.
+ */
+void RecordGenerator::generate(unsigned long long first, unsigned long long last,
+                               unsigned int duplicate_rate, unsigned int conflict_rate)
+{
+    for (unsigned long long i = first; i < last; i++)
+    {
+        unsigned int kind = mix(seed + i * 3) % 100;
+        if ((kind >= duplicate_rate + conflict_rate || used_pairs == 0) && used_pairs < num_pairs)
+        // A new pair
+        {
+            writeRecord((used_pairs * step) % num_pairs, false);
+            used_pairs++;
+            continue;
+        }
+        // A pair that has already been used (always a duplicate, if every pair has been used)
+        unsigned long long pair = ((mix(seed + i * 3 + 1) % used_pairs) * step) % num_pairs;
+        writeRecord(pair, kind >= duplicate_rate && used_pairs < num_pairs);
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 6 || argc % 2 != 0)
+    {
+        printf("Execution format: ./recordGenerator <viruses_file> <countries_file> <num_records> <output_dir> <files_per_country>"
+               " [-d <duplicate %%>] [-x <conflict %%>] [-s <seed>]\n");
+        return 1;
+    }
+    unsigned long long num_records = strtoull(argv[3], NULL, 10);
+    unsigned int files_per_country = strtoul(argv[5], NULL, 10);
+    unsigned int duplicate_rate = 0, conflict_rate = 0;
+    unsigned long long seed = 1;
+    for (int i = 6; i < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-d") == 0) { duplicate_rate = strtoul(argv[i + 1], NULL, 10); }
+        else if (strcmp(argv[i], "-x") == 0) { conflict_rate = strtoul(argv[i + 1], NULL, 10); }
+        else if (strcmp(argv[i], "-s") == 0) { seed = strtoull(argv[i + 1], NULL, 10); }
+        else
+        {
+            printf("Invalid argument detected: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (files_per_country == 0 || files_per_country > MAX_FILES_PER_COUNTRY || duplicate_rate + conflict_rate > 100)
+    {
+        printf("Files per country must be in [1, %d], and the duplicate & conflict percentages must not exceed 100 in total.\n",
+               MAX_FILES_PER_COUNTRY);
+        return 1;
+    }
+
+    unsigned int num_viruses, num_countries;
+    char **viruses = readLines(argv[1], num_viruses);
+    char **countries = readLines(argv[2], num_countries);
+    if (viruses == NULL || countries == NULL || num_viruses == 0 || num_countries == 0)
+    {
+        printf("Unable to read the specified viruses/countries file.\n");
+        return 1;
+    }
+    if (mkdir(argv[4], 0755) != 0)
+    {
+        printf("Unable to create the output directory (it must not exist).\n");
+        return 1;
+    }
+
+    RecordGenerator generator(countries, num_countries, viruses, num_viruses, num_records, seed);
+    if (num_records * (100 - duplicate_rate - conflict_rate) / 100 > generator.maxDistinctRecords())
+    {
+        printf("Only %llu distinct (citizen, virus) pairs exist, so the rest of the records will be duplicates.\n",
+               generator.maxDistinctRecords());
+    }
+    // The records are written in the files of each country in turn, so that only 1 file per country is open at a time
+    bool success = true;
+    for (unsigned int i = 0; success && i < files_per_country; i++)
+    {
+        success = generator.openFiles(argv[4], i + 1);
+        if (success)
+        {
+            generator.generate(num_records * i / files_per_country, num_records * (i + 1) / files_per_country,
+                               duplicate_rate, conflict_rate);
+        }
+        generator.closeFiles();
+    }
+
+    for (unsigned int i = 0; i < num_viruses; i++)
+    {
+        delete[] viruses[i];
+    }
+    for (unsigned int i = 0; i < num_countries; i++)
+    {
+        delete[] countries[i];
+    }
+    delete[] viruses;
+    delete[] countries;
+    if (!success) { return 1; }
+    printf("Generated %llu records in %s.\n", num_records, argv[4]);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#!/bin/bash
+# File: startup_bench.sh
+# Generates records with recordGenerator, and measures the time until travelMonitorClient
+# (and Project 1 vaccineMonitor, if it has been built) reaches command line mode, i.e. until all the records are loaded.
+# Pavlos Spanoudakis (sdi1800184)
+
+usage="Usage: ./bench/startup_bench.sh <num records> [numMonitors] [numThreads] [filesPerCountry] [duplicate %] [conflict %]"
+
+if [[ "$#" -lt 1 ]]; then
+    echo "$usage"
+    exit 1
+fi
+
+numRecords=$1
+numMonitors=${2:-4}
+numThreads=${3:-4}
+filesPerCountry=${4:-4}
+duplicateRate=${5:-5}
+conflictRate=${6:-1}
+bloomSize=100000
+socketBuffer=4096
+cyclicBuffer=16
+
+# Run from the project root (where the executables are)
+cd "$(dirname "$0")/.." || exit 1
+make all bench > /dev/null || exit 1
+
+dataDir=$(mktemp -d)
+inputDir="$dataDir/input_dir"
+trap 'rm -rf "$dataDir"' EXIT
+
+# Prints the milliseconds since the given start time (in nanoseconds), when command line mode is reached
+timeStartup()
+{
+    local start=$1
+    while read -r line; do
+        if [[ "$line" == "Now in command line mode."* ]]; then
+            echo $(( ($(date +%s%N) - start) / 1000000 ))
+        fi
+    done
+}
+
+start=$(date +%s%N)
+./recordGenerator ../project1/sample_data/viruses.txt ../project1/sample_data/countries.txt "$numRecords" "$inputDir" \
+                  "$filesPerCountry" -d "$duplicateRate" -x "$conflictRate" || exit 1
+echo "Generation: $(( ($(date +%s%N) - start) / 1000000 )) ms"
+
+start=$(date +%s%N)
+elapsed=$(echo "/exit" | ./travelMonitorClient -m "$numMonitors" -b "$socketBuffer" -c "$cyclicBuffer" -s "$bloomSize" \
+                                             -i "$inputDir" -t "$numThreads" 2> /dev/null | timeStartup "$start")
+echo "travelMonitorClient startup ($numMonitors monitors, $numThreads threads each): $elapsed ms"
+
+if [[ -x ../project1/vaccineMonitor ]]; then
+    cat "$inputDir"/*/* > "$dataDir/inputFile"
+    start=$(date +%s%N)
+    elapsed=$(echo "/exit" | ../project1/vaccineMonitor -c "$dataDir/inputFile" -b "$bloomSize" 2> /dev/null | timeStartup "$start")
+    echo "vaccineMonitor startup: $elapsed ms"
+fi
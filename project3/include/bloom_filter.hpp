@@ -7,7 +7,9 @@
 #ifndef BLOOM_FILTER_HPP
 #define BLOOM_FILTER_HPP
 
-#define K_MAX 11    // Number of Hash Functions used for inserting/detecting data.
+#define K_MAX 11            // Maximum number of Hash Functions used for inserting/detecting data.
+#define BLOOM_MIN_SIZE 8    // Minimum size (in bytes) selected by BloomFilter::chooseParameters
+#define BLOOM_WORD_SIZE 4   // Number of bytes in a Bloom Filter "word" (used for tracking changes and sending filters)
 
 /**
  * A simple Bloom Filter, implemented using an array of chars.
@@ -17,18 +19,35 @@ class BloomFilter
 {
     private:
         const unsigned long numBits;        // The numer of bits in the Bloom Filter.
+        unsigned char *changed_words;       // 1 bit for each word, set when the word has changed since clearChanges().
+                                            // NULL if changes are not tracked.
+        unsigned long numChangedWords;
         void setBit(unsigned long n);
         bool getBit(unsigned long n) const;
     public:
         const unsigned long numBytes;
+        const unsigned long numWords;       // The number of BLOOM_WORD_SIZE words (the last one may be partial).
+        const unsigned int numHashes;       // The number of Hash Functions used (up to K_MAX).
         unsigned char *bits;                // The bits of the Bloom Filter (an array of unsigned chars).
-        BloomFilter(unsigned long n);
+        BloomFilter(unsigned long n, bool track_changes = false, unsigned int k = K_MAX);
         BloomFilter(unsigned char *bits, unsigned long n);
         ~BloomFilter();        
         bool isPresent(void *data) const;
         void markAsPresent(void *data);
         void copy(const BloomFilter& other);
         void copy(const unsigned char *bits, const unsigned long n);
+        void merge(const unsigned char *src, unsigned long offset, unsigned long n);
+        bool canFold(unsigned long n, unsigned int k) const;
+        void mergeFolded(const unsigned char *src, unsigned long offset, unsigned long n);
+        bool isWordChanged(unsigned long word) const;
+        unsigned long getNumChangedWords() const;
+        void clearChanges();
+        unsigned long countSetBits() const;
+        double fillRatio() const;
+        double estimatedItems() const;
+        double estimatedFalsePositiveRate() const;
+        static unsigned long optimalSize(unsigned long expected_items);
+        static void chooseParameters(unsigned long items, unsigned long max_bytes, unsigned long &bytes, unsigned int &k);
 };
 
 #endif
@@ -0,0 +1,28 @@
+/**
+ * File: fenwick_tree.hpp
+ * Fenwick Tree class definition.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#ifndef FENWICK_TREE_HPP
+#define FENWICK_TREE_HPP
+
+/**
+ * A Fenwick (Binary Indexed) Tree of counters. Both updating a counter
+ * and counting the sum of a range of counters take O(log n) time.
+ */
+class FenwickTree
+{
+    private:
+        const unsigned int size;            // The number of counters.
+        unsigned int *tree;                 // The partial sums (tree[i - 1] refers to counter i, 1-based).
+    public:
+        FenwickTree(unsigned int n);
+        ~FenwickTree();
+        unsigned int getSize() const;
+        void add(unsigned int index, int value);
+        unsigned int prefixSum(unsigned int index) const;
+        unsigned int rangeSum(unsigned int first, unsigned int last) const;
+};
+
+#endif
@@ -28,6 +28,7 @@ class HashTable
         ~HashTable();
         void insert(void *element);
         void* getElement(void *key, CompareFunc compare_func) const;
+        void* getElement(int hash_object, void *key, CompareFunc compare_func) const;
 };
 
 #endif
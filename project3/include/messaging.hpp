@@ -7,35 +7,89 @@
 #ifndef MSG_HPP
 #define MSG_HPP
 
+#include "stats.hpp"
+
 class BloomFilter;
+class ScalableBloomFilter;
+class RoaringBitmap;
 class Date;
 
+/* Encodings used when sending the byte array of a Bloom Filter (stage). */
+#define BLOOM_ENCODING_RAW 0        // The whole byte array
+#define BLOOM_ENCODING_RLE 1        // Run lengths of zero/non-zero words, followed by the non-zero words
+#define BLOOM_ENCODING_SPARSE 2     // (word index, word) pairs for every non-zero (or changed) word
+#define BLOOM_HEADER_SIZE 10        // Encoding (1 byte), filter size (4), number of Hash Functions (1), payload size (4)
+
+/* Routines with separate traffic counters (indices of sent_traffic/received_traffic). */
+#define TRAFFIC_MESSAGE_TYPE 0
+#define TRAFFIC_INT 1
+#define TRAFFIC_SHORT_INT 2
+#define TRAFFIC_LONG_INT 3
+#define TRAFFIC_STRING 4
+#define TRAFFIC_DATE 5
+#define TRAFFIC_BLOOM_FILTER 6
+#define TRAFFIC_HISTOGRAM 7
+#define TRAFFIC_ID_BITMAP 8
+#define TRAFFIC_ROUTINES 9
+
+/**
+ * The number of calls of a routine, and the bytes it has sent/received with its own read()/write() calls
+ * (e.g. the length of a string is counted in the traffic of sendInt/receiveInt, not sendString/receiveString).
+ */
+struct RoutineTraffic {
+    Counter calls;
+    Counter bytes;
+};
+
+extern RoutineTraffic sent_traffic[TRAFFIC_ROUTINES];
+extern RoutineTraffic received_traffic[TRAFFIC_ROUTINES];
+extern const char *send_routine_names[TRAFFIC_ROUTINES];
+extern const char *receive_routine_names[TRAFFIC_ROUTINES];
+
 /* Routines used for sending data. */
 
 void sendMessageType(int fd, char req_type, char *buffer, unsigned int buffer_size);
 
-void sendBloomFilter(int fd, BloomFilter *filter, char *buffer, unsigned int buffer_size);
+void sendBloomFilter(int fd, ScalableBloomFilter *filter, char *buffer, unsigned int buffer_size);
+
+void sendBloomFilterChanges(int fd, ScalableBloomFilter *filter, char *buffer, unsigned int buffer_size);
+
+void sendIdBitmap(int fd, RoaringBitmap *bitmap, char *buffer, unsigned int buffer_size);
+
+void sendIdBitmapChanges(int fd, RoaringBitmap *bitmap, char *buffer, unsigned int buffer_size);
 
 void sendInt(int fd, const unsigned int i, char *buffer, unsigned int buffer_size);
 
 void sendShortInt(int fd, const unsigned short int i, char *buffer, unsigned int buffer_size);
 
+void sendLongInt(int fd, const unsigned long long i, char *buffer, unsigned int buffer_size);
+
 void sendString(int fd, const char *string, char *buffer, unsigned int buffer_size);
 
 void sendDate(int fd, const Date &date, char *buffer, unsigned int buffer_size);
 
+void sendLatencyHistogram(int fd, const LatencyHistogram &histogram, char *buffer, unsigned int buffer_size);
+
 /* Routines used for receiving data. */
 
 void receiveMessageType(int fd, char &req_type, char *buffer, unsigned int buffer_size);
 
 void receiveString(int fd, char *&string, char *buffer, unsigned int buffer_size);
 
-void updateBloomFilter(int fd, BloomFilter *filter, char *buffer, unsigned int buffer_size);
+bool updateBloomFilter(int fd, ScalableBloomFilter *filter, char *buffer, unsigned int buffer_size);
+
+ScalableBloomFilter* receiveBloomFilter(int fd, char *buffer, unsigned int buffer_size);
+
+bool updateIdBitmap(int fd, RoaringBitmap *bitmap, uint32_t value_offset, char *buffer, unsigned int buffer_size);
 
 void receiveInt(int fd, unsigned int &i, char *buffer, unsigned int buffer_size);
 
 void receiveShortInt(int fd, unsigned short int &i, char *buffer, unsigned int buffer_size);
 
+void receiveLongInt(int fd, unsigned long long &i, char *buffer, unsigned int buffer_size);
+
 void receiveDate(int fd, Date &date, char *buffer, unsigned int buffer_size);
 
+void updateLatencyHistogram(int fd, LatencyHistogram &histogram, char *buffer, unsigned int buffer_size);
+
 #endif
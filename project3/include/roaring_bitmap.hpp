@@ -0,0 +1,78 @@
+/**
+ * File: roaring_bitmap.hpp
+ * Roaring Bitmap class definition.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#ifndef ROARING_BITMAP_HPP
+#define ROARING_BITMAP_HPP
+
+#include <cstdint>
+
+#define ROARING_ARRAY_MAX 4096          // Array containers with more values are converted to bitset containers
+#define ROARING_BITSET_WORDS 1024       // The number of 64-bit words in a bitset container (2^16 bits)
+#define ROARING_CONTAINER_HEADER 5      // Key (2 bytes), container type (1), cardinality - 1 (2)
+
+/* Container types (also used when serializing the containers). */
+#define ROARING_ARRAY 0
+#define ROARING_BITSET 1
+
+/**
+ * The values of a Roaring Bitmap with the same 16 most significant bits (the key).
+ * The 16 least significant bits of each value are stored either in a sorted array
+ * (up to ROARING_ARRAY_MAX values), or in a bitset of 2^16 bits.
+ */
+class RoaringContainer
+{
+    private:
+        uint16_t *values;               // Sorted values (NULL for bitset containers)
+        unsigned int capacity;          // The number of values that fit in the values array
+        uint64_t *words;                // The bitset (NULL for array containers)
+        void toBitset();
+        void insertAt(unsigned int pos, uint16_t value);
+        int findValue(uint16_t value, unsigned int &pos) const;
+    public:
+        const uint16_t key;
+        unsigned int cardinality;       // The number of values in the container
+        bool changed;                   // TRUE if values have been added since clearChanges()
+        RoaringContainer(uint16_t container_key);
+        ~RoaringContainer();
+        bool add(uint16_t value);
+        bool contains(uint16_t value) const;
+        char getType() const;
+        unsigned long getNumBytes() const;
+        unsigned long serializedSize() const;
+        unsigned char* serialize(unsigned char *dest) const;
+        const unsigned char* mergeSerialized(const unsigned char *src, char type, unsigned int count);
+};
+
+/**
+ * A compressed bitmap of 32-bit values, split in containers by their 16 most significant bits (see RoaringContainer).
+ * Sparse containers are stored as sorted arrays and dense ones as bitsets, so every container takes up to 8 KB.
+ * The containers are kept sorted by key.
+ */
+class RoaringBitmap
+{
+    private:
+        RoaringContainer **containers;
+        unsigned int numContainers;
+        unsigned int capacity;          // The number of containers that fit in the containers array
+        int findContainer(uint16_t key, unsigned int &pos) const;
+        RoaringContainer* getOrCreateContainer(uint16_t key);
+    public:
+        RoaringBitmap();
+        ~RoaringBitmap();
+        bool add(uint32_t value);
+        bool contains(uint32_t value) const;
+        unsigned long getCardinality() const;
+        unsigned int getNumContainers() const;
+        unsigned int getNumArrayContainers() const;
+        unsigned long getNumBytes() const;
+        bool hasChanges() const;
+        void clearChanges();
+        unsigned long serializedSize(bool changes_only) const;
+        void serialize(unsigned char *dest, bool changes_only) const;
+        bool mergeSerialized(const unsigned char *src, unsigned long size, uint32_t value_offset = 0);
+};
+
+#endif
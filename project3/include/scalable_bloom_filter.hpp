@@ -0,0 +1,52 @@
+/**
+ * File: scalable_bloom_filter.hpp
+ * Scalable Bloom Filter class definition.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#ifndef SCALABLE_BLOOM_FILTER_HPP
+#define SCALABLE_BLOOM_FILTER_HPP
+
+#include "bloom_filter.hpp"
+
+#define BLOOM_MAX_STAGES 16         // Maximum number of Bloom Filters in a chain
+#define BLOOM_GROWTH_FACTOR 2       // Each new Bloom Filter of a chain is this many times larger than the previous one
+#define BLOOM_TIGHTENING_RATIO 0.5  // The false positive target of each new Bloom Filter, relative to the previous one
+
+/**
+ * A Scalable Bloom Filter: a chain of Bloom Filters ("stages"), where only the last one is used for inserting data.
+ * When the last stage reaches its capacity, a new one is added, with BLOOM_GROWTH_FACTOR times its size
+ * (up to a maximum size), one more Hash Function (up to K_MAX) and BLOOM_TIGHTENING_RATIO times its
+ * false positive target, so that the total false positive rate remains bounded as more data are inserted.
+ */
+class ScalableBloomFilter
+{
+    private:
+        BloomFilter *stages[BLOOM_MAX_STAGES];
+        unsigned int numStages;
+        const unsigned long maxStageBytes;  // The maximum size of a new stage (0 if no stages are added on insertion).
+        const bool trackChanges;            // TRUE if the stages track their changes (see BloomFilter).
+        unsigned long lastStageItems;       // The number of items inserted in the last stage.
+        unsigned long lastStageCapacity;    // The number of items the last stage can take before a new one is added.
+        double lastStageTarget;             // The false positive target of the last stage.
+        void startStage(BloomFilter *stage, double target);
+    public:
+        ScalableBloomFilter(unsigned long n, unsigned int k = K_MAX, unsigned long max_stage_bytes = 0,
+                            bool track_changes = false);
+        ScalableBloomFilter(BloomFilter *first_stage);
+        ~ScalableBloomFilter();
+        unsigned int getNumStages() const;
+        BloomFilter* getStage(unsigned int i) const;
+        void appendStage(BloomFilter *stage);
+        bool isPresent(void *data) const;
+        void markAsPresent(void *data);
+        void countItems(unsigned long items);
+        bool merge(const ScalableBloomFilter &other);
+        unsigned long getNumBytes() const;
+        unsigned long getNumChangedWords() const;
+        void clearChanges();
+        double estimatedItems() const;
+        double estimatedFalsePositiveRate() const;
+};
+
+#endif
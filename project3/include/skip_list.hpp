@@ -10,6 +10,7 @@
 #include "utils.hpp"
 
 #define SKIP_LIST_MAX_LAYERS 30     // The maximum number of levels allowed in a Skip List.
+#define SKIP_LIST_DEFAULT_SEED 1    // The default seed of the generator used for selecting the level of new nodes.
 
 /**
  * A probabilistic ordered List structure, which allows significantly
@@ -35,15 +36,32 @@ class SkipList
         int curr_layer;             // The currently higher level of the list.
         SkipListNode **layer_heads; // An array of pointers to the first node of each level.
         DestroyFunc destroyElement; // Used for destroying elements when the skip list is being destroyed.
-        int getRandomLayer(void) const;
+        unsigned long long random_state;    // The state of the generator used for selecting the level of new nodes.
+        unsigned long long nextRandom(void);
+        int getRandomLayer(void);
         
     public:
-        SkipList(int layers, DestroyFunc dest);
+        /**
+         * Used for iterating over Skip List elements (in order).
+         */
+        class SkipListIterator
+        {
+            private:
+                SkipListNode *node;     // The actual Skip List node.
+            public:
+                SkipListIterator(SkipListNode *list_node);
+                void* getData() const;
+                void forward();
+                bool isNull() const;
+        };
+
+        SkipList(int layers, DestroyFunc dest, unsigned long long seed = SKIP_LIST_DEFAULT_SEED);
         ~SkipList();
         void* find(void *element, CompareFunc compare) const;
         bool insert(void *element, void **present, CompareFunc compare);
         void remove(void *element, void **present, CompareFunc compare);
         void displayElements(DisplayFunc print) const;
+        SkipListIterator listHead() const;
 };
 
 #endif
@@ -0,0 +1,47 @@
+/**
+ * File: stats.hpp
+ * Counter & Latency Histogram class definitions, used for runtime statistics.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#define LATENCY_BUCKETS 32      // Bucket 0 counts latencies < 1 us, bucket i > 0 counts latencies in [2^(i-1), 2^i) us
+
+/**
+ * A 64-bit counter that can be updated by many threads at the same time (using atomic operations).
+ */
+class Counter
+{
+    private:
+        unsigned long long value;
+    public:
+        Counter();
+        void add(unsigned long long n = 1);
+        unsigned long long get() const;
+};
+
+/**
+ * A histogram of latencies (in microseconds), with power-of-2 buckets.
+ * Latencies can be added by many threads at the same time (using atomic operations).
+ */
+class LatencyHistogram
+{
+    private:
+        unsigned long long buckets[LATENCY_BUCKETS];
+        unsigned long long total_micros;    // The sum of all the added latencies
+    public:
+        LatencyHistogram();
+        void add(unsigned long long micros);
+        void addBucket(unsigned int bucket, unsigned long long count);
+        void addTotal(unsigned long long micros);
+        unsigned long long getBucket(unsigned int bucket) const;
+        unsigned long long getCount() const;
+        unsigned long long getTotalMicros() const;
+        unsigned long long percentileBound(double percentile) const;
+};
+
+unsigned long long currentMicros();
+
+#endif
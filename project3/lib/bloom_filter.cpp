@@ -4,22 +4,35 @@
  * Pavlos Spanoudakis (sdi1800184)
  */
 
+#include <cstddef>
+#include <cstring>
+#include <cmath>
 #include "../include/bloom_filter.hpp"
 #include "../include/hash_functions.hpp"
 
 /**
- * Create a Bloom Filter with n bytes size.
+ * Create a Bloom Filter with n bytes size, which uses k Hash Functions (at most K_MAX).
+ * If track_changes is TRUE, the words that change after each clearChanges() call are tracked.
  */
-BloomFilter::BloomFilter(unsigned long n): numBits(n*8), numBytes(n), bits(new unsigned char[n])
+BloomFilter::BloomFilter(unsigned long n, bool track_changes, unsigned int k):
+numBits(n*8), changed_words(NULL), numChangedWords(0), numBytes(n),
+numWords((n + BLOOM_WORD_SIZE - 1) / BLOOM_WORD_SIZE), numHashes((k > 0 && k < K_MAX) ? k : K_MAX),
+bits(new unsigned char[n])
 {
     for (unsigned long i = 0; i < n; i++)
     {
         bits[i] = 0;    // All bytes are initialized to 0.
     }
+    if (track_changes)
+    {
+        changed_words = new unsigned char[(numWords + 7) / 8];
+        clearChanges();
+    }
 }
 
 BloomFilter::BloomFilter(unsigned char *bits, unsigned long n):
-numBits(n*8), numBytes(n), bits(new unsigned char[n])
+numBits(n*8), changed_words(NULL), numChangedWords(0), numBytes(n),
+numWords((n + BLOOM_WORD_SIZE - 1) / BLOOM_WORD_SIZE), numHashes(K_MAX), bits(new unsigned char[n])
 {
     for (unsigned long i = 0; i < this->numBytes; i++)
     {
@@ -30,6 +43,7 @@ numBits(n*8), numBytes(n), bits(new unsigned char[n])
 BloomFilter::~BloomFilter()
 {
     delete [] bits;
+    delete [] changed_words;
 }
 
 /**
@@ -49,6 +63,16 @@ void BloomFilter::setBit(unsigned long n)
         mask = mask*2;
     }
 
+    if (this->changed_words != NULL && (this->bits[target_byte] & mask) == 0)
+    // The bit is about to change, so mark its word as changed (if not already marked)
+    {
+        unsigned long word = target_byte / BLOOM_WORD_SIZE;
+        if ( !isWordChanged(word) )
+        {
+            this->changed_words[word / 8] |= (1 << (word % 8));
+            this->numChangedWords++;
+        }
+    }
     // Using bitwise OR to keep the rest of the bits unchanged
     this->bits[target_byte] = this->bits[target_byte] | mask;
 }
@@ -79,7 +103,7 @@ bool BloomFilter::getBit(unsigned long n) const
 bool BloomFilter::isPresent(void *data) const
 {
     unsigned long bit_num;      // The bit number to check every time
-    for (int i = 0; i < K_MAX; i++)
+    for (unsigned int i = 0; i < this->numHashes; i++)
     {
         bit_num = hash_i((unsigned char*)data, i) % this->numBits;
         if ( !getBit(bit_num) ) { return false; }
@@ -92,7 +116,7 @@ bool BloomFilter::isPresent(void *data) const
  */
 void BloomFilter::markAsPresent(void *data)
 {
-    for (int i = 0; i < K_MAX; i++)
+    for (unsigned int i = 0; i < this->numHashes; i++)
     {
         setBit(hash_i((unsigned char*)data, i) % this->numBits);
     }
@@ -117,3 +141,181 @@ void BloomFilter::copy(const unsigned char *bits, const unsigned long n)
         this->bits[i] = bits[i];
     }
 }
+
+/**
+ * Updates the bytes starting at the specified offset using bitwise-OR
+ * with the n bytes of src. Any bytes exceeding the filter size are ignored.
+ * The bytes are merged a whole machine word at a time, and only the remaining bytes one by one.
+ */
+void BloomFilter::merge(const unsigned char *src, unsigned long offset, unsigned long n)
+{
+    if (offset >= this->numBytes) { return; }
+    if (n > this->numBytes - offset)
+    {
+        n = this->numBytes - offset;
+    }
+    unsigned char *dest = this->bits + offset;
+    unsigned long i = 0;
+    unsigned long dest_word, src_word;
+    for (; i + sizeof(unsigned long) <= n; i += sizeof(unsigned long))
+    {
+        // memcpy() is used since the addresses may not be aligned (it is optimized away by the compiler)
+        memcpy(&dest_word, dest + i, sizeof(unsigned long));
+        memcpy(&src_word, src + i, sizeof(unsigned long));
+        dest_word |= src_word;
+        memcpy(dest + i, &dest_word, sizeof(unsigned long));
+    }
+    for (; i < n; i++)
+    {
+        dest[i] |= src[i];
+    }
+}
+
+/**
+ * Returns TRUE if a filter with n bytes that uses k Hash Functions can be merged in this filter,
+ * i.e. if it uses the same Hash Functions and its size is a multiple of the size of this filter.
+ * Since the bit of each item is its hash modulo the number of bits, a bit of the larger filter
+ * corresponds to the bit with the same offset modulo the size of this filter ("folding").
+ */
+bool BloomFilter::canFold(unsigned long n, unsigned int k) const
+{
+    return k == this->numHashes && n >= this->numBytes && n % this->numBytes == 0;
+}
+
+/**
+ * Updates this filter using bitwise-OR with the n bytes of src, which start at the specified offset
+ * of a filter that can be folded in this filter (see canFold).
+ */
+void BloomFilter::mergeFolded(const unsigned char *src, unsigned long offset, unsigned long n)
+{
+    while (n > 0)
+    {
+        unsigned long dest_offset = offset % this->numBytes;
+        unsigned long len = (n < this->numBytes - dest_offset) ? n : (this->numBytes - dest_offset);
+        merge(src, dest_offset, len);
+        src += len;
+        offset += len;
+        n -= len;
+    }
+}
+
+/**
+ * Returns TRUE if the specified word has changed since the last clearChanges() call, FALSE otherwise.
+ * If changes are not tracked, every word is considered changed.
+ */
+bool BloomFilter::isWordChanged(unsigned long word) const
+{
+    if (this->changed_words == NULL) { return true; }
+    return (this->changed_words[word / 8] & (1 << (word % 8))) != 0;
+}
+
+/**
+ * Returns the number of words that have changed since the last clearChanges() call.
+ * If changes are not tracked, every word is considered changed.
+ */
+unsigned long BloomFilter::getNumChangedWords() const
+{
+    if (this->changed_words == NULL) { return this->numWords; }
+    return this->numChangedWords;
+}
+
+/**
+ * Marks all the words as unchanged. Does nothing if changes are not tracked.
+ */
+void BloomFilter::clearChanges()
+{
+    if (this->changed_words == NULL) { return; }
+    for (unsigned long i = 0; i < (this->numWords + 7) / 8; i++)
+    {
+        this->changed_words[i] = 0;
+    }
+    this->numChangedWords = 0;
+}
+
+/**
+ * Returns the number of bits that are set to 1.
+ * The bits are counted a whole machine word at a time, and only the remaining bytes one by one.
+ */
+unsigned long BloomFilter::countSetBits() const
+{
+    unsigned long count = 0;
+    unsigned long i = 0;
+    unsigned long word;
+    for (; i + sizeof(unsigned long) <= this->numBytes; i += sizeof(unsigned long))
+    {
+        memcpy(&word, this->bits + i, sizeof(unsigned long));
+        count += __builtin_popcountl(word);
+    }
+    for (; i < this->numBytes; i++)
+    {
+        count += __builtin_popcount(this->bits[i]);
+    }
+    return count;
+}
+
+/**
+ * Returns the fraction of the bits that are set to 1.
+ */
+double BloomFilter::fillRatio() const
+{
+    return (double)countSetBits() / this->numBits;
+}
+
+/**
+ * Returns an estimation of the number of distinct items that have been marked as present,
+ * based on the number of set bits (the estimation is infinite if all the bits are set).
+ */
+double BloomFilter::estimatedItems() const
+{
+    return -((double)this->numBits / this->numHashes) * log(1 - fillRatio());
+}
+
+/**
+ * Returns the probability that an item that has not been marked as present is found "maybe present",
+ * based on the number of set bits.
+ */
+double BloomFilter::estimatedFalsePositiveRate() const
+{
+    return pow(fillRatio(), this->numHashes);
+}
+
+/**
+ * Returns the size (in bytes) that minimizes the false positive rate of a filter
+ * with the specified number of distinct items (using K_MAX hash functions), i.e. K_MAX * items / ln(2) bits.
+ */
+unsigned long BloomFilter::optimalSize(unsigned long expected_items)
+{
+    unsigned long bytes = (unsigned long)ceil(K_MAX * (double)expected_items / M_LN2 / 8);
+    return (bytes > 0) ? bytes : 1;
+}
+
+/**
+ * Chooses the parameters of a filter for the specified number of distinct items:
+ * the smallest power of 2 bytes (at least BLOOM_MIN_SIZE) that is not less than optimalSize(items),
+ * unless it exceeds max_bytes, in which case the largest power of 2 not exceeding max_bytes is chosen,
+ * and the number of Hash Functions that minimizes the false positive rate with this size (at most K_MAX).
+ * Since all the possible sizes are powers of 2, a larger filter can always be folded in a smaller one
+ * with the same number of Hash Functions (see canFold).
+ */
+void BloomFilter::chooseParameters(unsigned long items, unsigned long max_bytes, unsigned long &bytes, unsigned int &k)
+{
+    unsigned long needed = optimalSize(items);
+    bytes = 1;
+    while (bytes < needed || bytes < BLOOM_MIN_SIZE)
+    {
+        bytes *= 2;
+    }
+    while (bytes > max_bytes && bytes > 1)
+    {
+        bytes /= 2;
+    }
+    k = K_MAX;
+    if (items > 0)
+    {
+        double optimal_k = 8 * (double)bytes / items * M_LN2;
+        if (optimal_k < K_MAX)
+        {
+            k = (optimal_k < 1) ? 1 : (unsigned int)(optimal_k + 0.5);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * File: fenwick_tree.cpp
+ * Fenwick Tree class implementation.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#include "../include/fenwick_tree.hpp"
+
+/**
+ * Creates a Fenwick Tree with n counters (indexed 0 to n - 1), all set to 0.
+ */
+FenwickTree::FenwickTree(unsigned int n): size(n), tree(new unsigned int[n])
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        tree[i] = 0;
+    }
+}
+
+FenwickTree::~FenwickTree()
+{
+    delete[] tree;
+}
+
+unsigned int FenwickTree::getSize() const
+{
+    return size;
+}
+
+/**
+ * Adds value (which may be negative) to the counter with the specified index.
+ */
+void FenwickTree::add(unsigned int index, int value)
+{
+    // Update every partial sum that includes the counter
+    for (unsigned int i = index + 1; i <= size; i += i & (-i))
+    {
+        tree[i - 1] += value;
+    }
+}
+
+/**
+ * Returns the sum of the counters with indexes 0 to index (inclusive).
+ */
+unsigned int FenwickTree::prefixSum(unsigned int index) const
+{
+    unsigned int sum = 0;
+    if (index >= size)
+    {
+        index = size - 1;
+    }
+    // Add the partial sums that cover [0, index]
+    for (unsigned int i = index + 1; i > 0; i -= i & (-i))
+    {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+/**
+ * Returns the sum of the counters with indexes first to last (inclusive).
+ */
+unsigned int FenwickTree::rangeSum(unsigned int first, unsigned int last) const
+{
+    if (first > last)
+    {
+        return 0;
+    }
+    return prefixSum(last) - ((first > 0) ? prefixSum(first - 1) : 0);
+}
@@ -106,3 +106,23 @@ void* HashTable::getElement(void *key, CompareFunc compare_func) const
     // Search the bucket for the element.
     return buckets[hash_code]->getElement(key, compare_func);
 }
+
+/**
+ * Returns the first element in the Hash Table which is equal to the specified key,
+ * according to the specified comparison function, where hash_object is the integer
+ * that the hash function returns for the key (used for keys that are not integers, e.g. strings).
+ * If such element was not found, returns NULL.
+ */
+void* HashTable::getElement(int hash_object, void *key, CompareFunc compare_func) const
+{
+    // Get the hashcode of the key hash object
+    unsigned int hash_code = getHashCode(&hash_object, this->size);
+
+    if (buckets[hash_code] == NULL)
+    // If the corresponding bucket is empty, return NULL
+    {
+        return NULL;
+    }
+    // Search the bucket for the element.
+    return buckets[hash_code]->getElement(key, compare_func);
+}
@@ -18,7 +18,8 @@ LinkedList::ListNode::ListNode(): next(NULL), data(NULL) {}
 
 /**
  * Create a Linked List.
- * @param dest The function to be used for destroying elements when the list is being destroyed.
+ * @param dest The function to be used for destroying elements when the list is being destroyed
+ * (NULL if the list does not own its elements).
  */
 LinkedList::LinkedList(DestroyFunc dest):
  head(NULL), last(NULL), destroy(dest), numElements(0) { }
@@ -33,7 +34,10 @@ LinkedList::~LinkedList()
         // Skip the head node
         head = head->next;
         // Delete the previous node data, and the node itself
-        destroy(temp->data);
+        if (destroy != NULL)
+        {
+            destroy(temp->data);
+        }
         delete temp;
     }    
 }
@@ -10,11 +10,46 @@
 #include <cerrno>
 #include <unistd.h>
 #include <netinet/in.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <poll.h>
 
 #include "../include/messaging.hpp"
 #include "../include/bloom_filter.hpp"
+#include "../include/scalable_bloom_filter.hpp"
+#include "../include/roaring_bitmap.hpp"
 #include "../app/app_utils.hpp"
 
+#if defined(USE_MSG_ZEROCOPY) && defined(__linux__)
+#include <linux/errqueue.h>
+#ifdef SO_ZEROCOPY
+#define BLOOM_USE_ZEROCOPY
+#include "../include/linked_list.hpp"
+#endif
+#endif
+
+RoutineTraffic sent_traffic[TRAFFIC_ROUTINES];
+RoutineTraffic received_traffic[TRAFFIC_ROUTINES];
+
+const char *send_routine_names[TRAFFIC_ROUTINES] = {
+    "sendMessageType", "sendInt", "sendShortInt", "sendLongInt",
+    "sendString", "sendDate", "sendBloomFilter", "sendLatencyHistogram", "sendIdBitmap"
+};
+
+const char *receive_routine_names[TRAFFIC_ROUTINES] = {
+    "receiveMessageType", "receiveInt", "receiveShortInt", "receiveLongInt",
+    "receiveString", "receiveDate", "updateBloomFilter", "updateLatencyHistogram", "updateIdBitmap"
+};
+
+/**
+ * Adds a call of the specified routine, which has sent/received the given bytes, to its traffic counters.
+ */
+static void countTraffic(RoutineTraffic *traffic, unsigned int routine, unsigned long long bytes)
+{
+    traffic[routine].calls.add();
+    traffic[routine].bytes.add(bytes);
+}
+
 /**
  * @brief Writes the specified message type in the file with the given file descriptor,
  * using the given buffer with the specified size.
@@ -26,6 +61,7 @@
  */
 void sendMessageType(int fd, char req_type, char *buffer, unsigned int buffer_size)
 {
+    countTraffic(sent_traffic, TRAFFIC_MESSAGE_TYPE, sizeof(char));
     unsigned int bytes_to_write, bytes_left;
     int written;
     for(unsigned int sent_bytes = 0; sent_bytes < sizeof(char); sent_bytes += bytes_to_write)
@@ -57,44 +93,483 @@ void sendMessageType(int fd, char req_type, char *buffer, unsigned int buffer_si
 }
 
 /**
- * @brief Writes the bytes array of the specified Bloom Filter in the file
- *  with the given file descriptor, using the given buffer with the specified size.
+ * Stores the specified integer in network byte order at the given address.
+ */
+static void storeWireInt(unsigned char *dest, unsigned int i)
+{
+    uint32_t net_i = htonl(i);
+    memcpy(dest, &net_i, sizeof(uint32_t));
+}
+
+/**
+ * Returns the integer stored in network byte order at the given address.
+ */
+static unsigned int loadWireInt(const unsigned char *src)
+{
+    uint32_t net_i;
+    memcpy(&net_i, src, sizeof(uint32_t));
+    return ntohl(net_i);
+}
+
+/**
+ * Returns TRUE if the specified word of the Bloom Filter has no bits set, FALSE otherwise.
+ * The last word of the filter may be partial.
+ */
+static bool isZeroWord(const BloomFilter *filter, unsigned long word)
+{
+    unsigned long end = (word + 1)*BLOOM_WORD_SIZE;
+    if (end > filter->numBytes)
+    {
+        end = filter->numBytes;
+    }
+    for (unsigned long i = word*BLOOM_WORD_SIZE; i < end; i++)
+    {
+        if (filter->bits[i] != 0) { return false; }
+    }
+    return true;
+}
+
+/**
+ * Copies the specified word of the Bloom Filter in dest (BLOOM_WORD_SIZE bytes).
+ * If the word is partial, the missing bytes are set to 0.
+ */
+static void copyWord(unsigned char *dest, const BloomFilter *filter, unsigned long word)
+{
+    unsigned long offset = word*BLOOM_WORD_SIZE;
+    unsigned long n = filter->numBytes - offset < BLOOM_WORD_SIZE ? filter->numBytes - offset : BLOOM_WORD_SIZE;
+    memset(dest, 0, BLOOM_WORD_SIZE);
+    memcpy(dest, filter->bits + offset, n);
+}
+
+/**
+ * @brief Encodes the byte array of the specified Bloom Filter, using the encoding
+ * that produces the smallest payload (see messaging.hpp for the available encodings).
+ * 
+ * @param filter The Bloom Filter to encode.
+ * @param changes_only If TRUE, the words that have not changed since the last filter->clearChanges()
+ * call may be omitted from the payload.
+ * @param encoding The selected encoding will be stored here.
+ * @param payload_size The size of the returned payload will be stored here.
+ * 
+ * @returns A heap array with the encoded payload, which must be deleted after use,
+ * or NULL if the payload is the byte array of the filter itself (BLOOM_ENCODING_RAW).
+ */
+static unsigned char* encodeBloomFilter(const BloomFilter *filter, bool changes_only,
+                                        char &encoding, unsigned long &payload_size)
+{
+    unsigned long num_words = filter->numWords;
+    unsigned long non_zero_words = 0, num_runs = 0, sparse_words = 0;
+    bool prev_zero = true;
+    // Count the non-zero words, as well as the runs of non-zero words
+    for (unsigned long w = 0; w < num_words; w++)
+    {
+        bool zero = isZeroWord(filter, w);
+        if (!zero)
+        {
+            non_zero_words++;
+            if (prev_zero) { num_runs++; }
+            if (!changes_only || filter->isWordChanged(w)) { sparse_words++; }
+        }
+        prev_zero = zero;
+    }
+    unsigned long rle_size = sizeof(uint32_t) + num_runs*2*sizeof(uint32_t) + non_zero_words*BLOOM_WORD_SIZE;
+    unsigned long sparse_size = sizeof(uint32_t) + sparse_words*(sizeof(uint32_t) + BLOOM_WORD_SIZE);
+
+    unsigned char *payload;
+    if (filter->numBytes <= rle_size && filter->numBytes <= sparse_size)
+    // The filter is dense, so just send the byte array (no payload is created)
+    {
+        encoding = BLOOM_ENCODING_RAW;
+        payload_size = filter->numBytes;
+        payload = NULL;
+    }
+    else if (sparse_size <= rle_size)
+    // Send (word index, word) pairs for every non-zero (or changed) word
+    {
+        encoding = BLOOM_ENCODING_SPARSE;
+        payload_size = sparse_size;
+        payload = new unsigned char[payload_size];
+        unsigned char *pos = payload;
+        storeWireInt(pos, sparse_words);
+        pos += sizeof(uint32_t);
+        for (unsigned long w = 0; w < num_words; w++)
+        {
+            if (changes_only && !filter->isWordChanged(w)) { continue; }
+            if (isZeroWord(filter, w)) { continue; }
+            storeWireInt(pos, w);
+            pos += sizeof(uint32_t);
+            copyWord(pos, filter, w);
+            pos += BLOOM_WORD_SIZE;
+        }
+    }
+    else
+    // Send (zero words, non-zero words) run lengths, each followed by the non-zero words
+    {
+        encoding = BLOOM_ENCODING_RLE;
+        payload_size = rle_size;
+        payload = new unsigned char[payload_size];
+        unsigned char *pos = payload;
+        storeWireInt(pos, num_runs);
+        pos += sizeof(uint32_t);
+        unsigned long w = 0;
+        while (w < num_words)
+        {
+            unsigned long zero_words = 0, literal_words = 0;
+            while (w < num_words && isZeroWord(filter, w))
+            {
+                zero_words++;
+                w++;
+            }
+            if (w == num_words) { break; }
+            unsigned char *literal = pos + 2*sizeof(uint32_t);
+            while (w < num_words && !isZeroWord(filter, w))
+            {
+                copyWord(literal, filter, w);
+                literal += BLOOM_WORD_SIZE;
+                literal_words++;
+                w++;
+            }
+            storeWireInt(pos, zero_words);
+            storeWireInt(pos + sizeof(uint32_t), literal_words);
+            pos = literal;
+        }
+    }
+    return payload;
+}
+
+/**
+ * @brief Writes all the bytes described by the given I/O vector in the file with the given
+ * file descriptor, with as few writev() calls as possible (no intermediate buffer is used).
+ * The I/O vector is modified to keep track of partial writes.
  * 
  * @param fd The file descriptor of the file to write the data.
- * @param filter The Bloom Filter to send.
- * @param buffer The buffer to copy the data before writing to the file.
- * @param buffer_size The size of the buffer.
+ * @param iov The I/O vector with the bytes to write.
+ * @param iovcnt The number of elements in the I/O vector.
  */
-void sendBloomFilter(int fd, BloomFilter *filter, char *buffer, unsigned int buffer_size)
+static void sendVector(int fd, struct iovec *iov, int iovcnt)
 {
-    unsigned int bytes_to_write, bytes_left;
-    int written;
-    for(unsigned long sent_bytes = 0; sent_bytes < filter->numBytes; sent_bytes += bytes_to_write)
+    ssize_t written;
+    while (iovcnt > 0)
     {
-        bytes_left = filter->numBytes - sent_bytes;
-        bytes_to_write = bytes_left < buffer_size ? bytes_left : buffer_size;
-        memcpy(buffer, filter->bits + sent_bytes, bytes_to_write);
-        written = write(fd, buffer, bytes_to_write);
-        if (written < bytes_to_write)
+        written = writev(fd, iov, iovcnt);
+        if (written == -1)
         {
-            if (written == -1)
+            if (errno == EINTR)
             {
-                if (errno == EINTR)
-                {
-                    bytes_to_write = 0;
-                }
-                else
-                {
-                    perror("Fatal error while writing to file.\n");
-                    exit(EXIT_FAILURE);
-                }
+                continue;
             }
-            else
+            perror("Fatal error while writing to file.\n");
+            exit(EXIT_FAILURE);
+        }
+        // Skip the fully written elements, and advance the partially written one
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len)
+        {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+#ifdef BLOOM_USE_ZEROCOPY
+/**
+ * A socket with SO_ZEROCOPY enabled. The kernel identifies the MSG_ZEROCOPY sends of each socket
+ * by a counter (starting from 0 for every socket) in their completion notifications.
+ */
+struct ZerocopySocket {
+    int fd;
+    uint32_t next_send_id;      // The id of the next MSG_ZEROCOPY send on this socket
+
+    ZerocopySocket(int socket_fd) : fd(socket_fd), next_send_id(0) { }
+};
+
+static LinkedList zerocopy_sockets(delete_object<ZerocopySocket>);
+
+/**
+ * Compares the given file descriptor to the file descriptor of the specified ZerocopySocket.
+ */
+static int compareFdZerocopySocket(void *fd, void *zerocopy_socket)
+{
+    return *static_cast<int*>(fd) - static_cast<ZerocopySocket*>(zerocopy_socket)->fd;
+}
+
+/**
+ * Returns the ZerocopySocket of the socket with the given file descriptor, enabling SO_ZEROCOPY on it
+ * if needed, or NULL if zerocopy is not supported for this file descriptor.
+ * If the file descriptor has been reused by a new socket (e.g. for a restored Monitor), SO_ZEROCOPY
+ * is not enabled on it yet, so its send counter starts over.
+ */
+static ZerocopySocket* getZerocopySocket(int fd)
+{
+    ZerocopySocket *zerocopy_socket = static_cast<ZerocopySocket*>(zerocopy_sockets.getElement(&fd, compareFdZerocopySocket));
+    int enabled = 0;
+    socklen_t len = sizeof(enabled);
+    if (getsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enabled, &len) == -1)
+    {
+        return NULL;
+    }
+    if (!enabled)
+    {
+        int one = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == -1)
+        {
+            return NULL;
+        }
+        if (zerocopy_socket == NULL)
+        {
+            zerocopy_socket = new ZerocopySocket(fd);
+            zerocopy_sockets.append(zerocopy_socket);
+        }
+        zerocopy_socket->next_send_id = 0;
+    }
+    return zerocopy_socket;
+}
+
+/**
+ * @brief Sends all the bytes described by the given I/O vector through the socket with the given
+ * file descriptor, using MSG_ZEROCOPY, so that the kernel does not copy the bytes.
+ * Waits until the kernel has released the bytes before returning, since they may change afterwards.
+ * 
+ * @returns TRUE if the bytes were sent, FALSE if zerocopy is not supported for this file descriptor
+ * (in which case nothing has been sent).
+ */
+static bool sendVectorZerocopy(int fd, struct iovec *iov, int iovcnt)
+{
+    ZerocopySocket *zerocopy_socket = getZerocopySocket(fd);
+    if (zerocopy_socket == NULL)
+    {
+        return false;
+    }
+    // The completions report ranges of send ids, so the sends of this call are [first_send_id, next_send_id)
+    uint32_t first_send_id = zerocopy_socket->next_send_id, pending_sends = 0;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    while (msg.msg_iovlen > 0)
+    {
+        ssize_t written = sendmsg(fd, &msg, MSG_ZEROCOPY);
+        if (written == -1)
+        {
+            if (errno == EINTR || errno == ENOBUFS)
             {
-                bytes_to_write = written;
+                continue;
+            }
+            perror("Fatal error while writing to socket.\n");
+            exit(EXIT_FAILURE);
+        }
+        zerocopy_socket->next_send_id++;
+        pending_sends++;
+        while (msg.msg_iovlen > 0 && (size_t)written >= msg.msg_iov->iov_len)
+        {
+            written -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0)
+        {
+            msg.msg_iov->iov_base = static_cast<char*>(msg.msg_iov->iov_base) + written;
+            msg.msg_iov->iov_len -= written;
+        }
+    }
+
+    // Wait for the completion notifications in the socket error queue
+    uint32_t num_sends = zerocopy_socket->next_send_id - first_send_id;
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+    while (pending_sends > 0)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = 0;
+        if (poll(&pfd, 1, -1) == -1 && errno != EINTR)
+        {
+            perror("Fatal error while waiting for zerocopy completion.\n");
+            exit(EXIT_FAILURE);
+        }
+        struct msghdr err_msg;
+        memset(&err_msg, 0, sizeof(err_msg));
+        err_msg.msg_control = control;
+        err_msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &err_msg, MSG_ERRQUEUE) == -1)
+        {
+            continue;
+        }
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&err_msg); cm != NULL; cm = CMSG_NXTHDR(&err_msg, cm))
+        {
+            struct sock_extended_err *serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) { continue; }
+            // [ee_info, ee_data] is the range of completed sends (only the sends of this call are counted)
+            for (uint32_t id = serr->ee_info; id != serr->ee_data + 1; id++)
+            {
+                if (id - first_send_id < num_sends && pending_sends > 0)
+                {
+                    pending_sends--;
+                }
             }
         }
     }
+    return true;
+}
+#endif
+
+/**
+ * @brief Sends the encoded byte arrays of the stages of the specified Scalable Bloom Filter
+ * through the file with the given file descriptor.
+ * 
+ * The number of stages is sent first. For each stage, the encoding, the stage parameters (size & number of
+ * Hash Functions) and the payload size (the header) are sent, followed by the payload.
+ * Everything is written with a single writev() call, directly from the stage byte arrays or the encoded payloads.
+ * If BLOOM_USE_ZEROCOPY is defined, large filters are sent using MSG_ZEROCOPY (when supported).
+ * 
+ * @param fd The file descriptor of the file to write the data.
+ * @param filter The Scalable Bloom Filter to send.
+ * @param changes_only If TRUE, the unchanged words of the stages may be omitted (see encodeBloomFilter).
+ */
+static void sendEncodedBloomFilter(int fd, ScalableBloomFilter *filter, bool changes_only)
+{
+    unsigned int num_stages = filter->getNumStages();
+    unsigned char stages_header[sizeof(uint32_t)];
+    unsigned char headers[BLOOM_MAX_STAGES][BLOOM_HEADER_SIZE];
+    unsigned char *payloads[BLOOM_MAX_STAGES];
+    struct iovec iov[1 + 2*BLOOM_MAX_STAGES];
+
+    storeWireInt(stages_header, num_stages);
+    iov[0].iov_base = stages_header;
+    iov[0].iov_len = sizeof(stages_header);
+    unsigned long long total_bytes = sizeof(stages_header);
+    for (unsigned int i = 0; i < num_stages; i++)
+    {
+        BloomFilter *stage = filter->getStage(i);
+        char encoding;
+        unsigned long payload_size;
+        payloads[i] = encodeBloomFilter(stage, changes_only, encoding, payload_size);
+
+        // Header: the encoding, the stage parameters (size & number of Hash Functions) and the payload size
+        headers[i][0] = encoding;
+        storeWireInt(headers[i] + sizeof(char), stage->numBytes);
+        headers[i][sizeof(char) + sizeof(uint32_t)] = stage->numHashes;
+        storeWireInt(headers[i] + 2*sizeof(char) + sizeof(uint32_t), payload_size);
+
+        iov[1 + 2*i].iov_base = headers[i];
+        iov[1 + 2*i].iov_len = BLOOM_HEADER_SIZE;
+        iov[2 + 2*i].iov_base = (payloads[i] == NULL) ? stage->bits : payloads[i];
+        iov[2 + 2*i].iov_len = payload_size;
+        total_bytes += BLOOM_HEADER_SIZE + payload_size;
+    }
+    countTraffic(sent_traffic, TRAFFIC_BLOOM_FILTER, total_bytes);
+
+    #ifdef BLOOM_USE_ZEROCOPY
+    if (total_bytes < ZEROCOPY_MIN_BYTES || !sendVectorZerocopy(fd, iov, 1 + 2*num_stages))
+    {
+        sendVector(fd, iov, 1 + 2*num_stages);
+    }
+    #else
+    sendVector(fd, iov, 1 + 2*num_stages);
+    #endif
+
+    for (unsigned int i = 0; i < num_stages; i++)
+    {
+        delete[] payloads[i];
+    }
+    filter->clearChanges();
+}
+
+/**
+ * @brief Sends the byte arrays of the stages of the specified Scalable Bloom Filter through the file
+ *  with the given file descriptor.
+ * 
+ * For each stage, the encoding which produces the smallest payload is selected, and it is sent
+ * before the payload (along with the stage size, the number of Hash Functions and the payload size),
+ * so that the receiver can decode it.
+ * The data are written directly from the stages (or the encoded payloads), so the buffer is not used.
+ * 
+ * @param fd The file descriptor of the file to write the data.
+ * @param filter The Scalable Bloom Filter to send.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size Not used (kept for compatibility with the rest of the routines).
+ */
+void sendBloomFilter(int fd, ScalableBloomFilter *filter, char *buffer, unsigned int buffer_size)
+{
+    sendEncodedBloomFilter(fd, filter, false);
+}
+
+/**
+ * @brief Sends the words of the stages of the specified Scalable Bloom Filter that have changed since the
+ * filter was last sent, through the file with the given file descriptor.
+ * 
+ * The receiver (see updateBloomFilter) must already have all the previously sent words,
+ * since it will only update the words that are sent using bitwise-OR.
+ * Stages added after the filter was last sent only have changed words, so they are sent completely.
+ * If the changed words are too many, the whole stage may be sent instead.
+ * 
+ * @param fd The file descriptor of the file to write the data.
+ * @param filter The Scalable Bloom Filter to send.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size Not used (kept for compatibility with the rest of the routines).
+ */
+void sendBloomFilterChanges(int fd, ScalableBloomFilter *filter, char *buffer, unsigned int buffer_size)
+{
+    sendEncodedBloomFilter(fd, filter, true);
+}
+
+/**
+ * Sends the serialized Roaring Bitmap (see RoaringBitmap::serialize), preceded by its size,
+ * through the file with the given file descriptor, with a single writev() call.
+ * If changes_only is TRUE, only the containers that have changed since the bitmap was last sent are sent.
+ */
+static void sendSerializedIdBitmap(int fd, RoaringBitmap *bitmap, bool changes_only)
+{
+    unsigned long payload_size = bitmap->serializedSize(changes_only);
+    unsigned char header[sizeof(uint32_t)];
+    unsigned char *payload = new unsigned char[payload_size];
+    storeWireInt(header, payload_size);
+    bitmap->serialize(payload, changes_only);
+
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = payload;
+    iov[1].iov_len = payload_size;
+    countTraffic(sent_traffic, TRAFFIC_ID_BITMAP, sizeof(header) + payload_size);
+    sendVector(fd, iov, 2);
+
+    delete[] payload;
+    bitmap->clearChanges();
+}
+
+/**
+ * @brief Sends the specified Roaring Bitmap (e.g. of vaccinated citizen ID's) through the file
+ * with the given file descriptor. The size of the serialized bitmap is sent first.
+ * 
+ * @param fd The file descriptor of the file to write the data.
+ * @param bitmap The Roaring Bitmap to send.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size Not used (kept for compatibility with the rest of the routines).
+ */
+void sendIdBitmap(int fd, RoaringBitmap *bitmap, char *buffer, unsigned int buffer_size)
+{
+    sendSerializedIdBitmap(fd, bitmap, false);
+}
+
+/**
+ * @brief Sends the containers of the specified Roaring Bitmap that have changed since the bitmap
+ * was last sent, through the file with the given file descriptor.
+ * The receiver (see updateIdBitmap) must already have all the previously sent containers.
+ * 
+ * @param fd The file descriptor of the file to write the data.
+ * @param bitmap The Roaring Bitmap to send.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size Not used (kept for compatibility with the rest of the routines).
+ */
+void sendIdBitmapChanges(int fd, RoaringBitmap *bitmap, char *buffer, unsigned int buffer_size)
+{
+    sendSerializedIdBitmap(fd, bitmap, true);
 }
 
 /**
@@ -109,6 +584,7 @@ void sendBloomFilter(int fd, BloomFilter *filter, char *buffer, unsigned int buf
 void sendInt(int fd, const unsigned int i, char *buffer, unsigned int buffer_size)
 {
     uint32_t net_i = ntohl(i);
+    countTraffic(sent_traffic, TRAFFIC_INT, sizeof(uint32_t));
     unsigned int bytes_to_write, bytes_left;
     int written;
     for(unsigned int sent_bytes = 0; sent_bytes < sizeof(uint32_t); sent_bytes += bytes_to_write)
@@ -151,6 +627,7 @@ void sendInt(int fd, const unsigned int i, char *buffer, unsigned int buffer_siz
 void sendShortInt(int fd, const unsigned short int i, char *buffer, unsigned int buffer_size)
 {
     uint16_t net_i = htons(i);
+    countTraffic(sent_traffic, TRAFFIC_SHORT_INT, sizeof(uint16_t));
     unsigned int bytes_to_write, bytes_left;
     int written;
     for(unsigned int sent_bytes = 0; sent_bytes < sizeof(uint16_t); sent_bytes += bytes_to_write)
@@ -181,6 +658,42 @@ void sendShortInt(int fd, const unsigned short int i, char *buffer, unsigned int
     }
 }
 
+/**
+ * Stores the specified 64-bit integer in network byte order (most significant half first) at the given address.
+ */
+static void storeWireLongInt(unsigned char *dest, unsigned long long i)
+{
+    storeWireInt(dest, i >> 32);
+    storeWireInt(dest + sizeof(uint32_t), i & 0xFFFFFFFFULL);
+}
+
+/**
+ * Returns the 64-bit integer stored in network byte order (most significant half first) at the given address.
+ */
+static unsigned long long loadWireLongInt(const unsigned char *src)
+{
+    return ((unsigned long long)loadWireInt(src) << 32) | loadWireInt(src + sizeof(uint32_t));
+}
+
+/**
+ * @brief Writes the specified 64-bit integer in the file with the given file descriptor.
+ * 
+ * @param fd The file descriptor of the file to write the data.
+ * @param i The integer to send.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size Not used (kept for compatibility with the rest of the routines).
+ */
+void sendLongInt(int fd, const unsigned long long i, char *buffer, unsigned int buffer_size)
+{
+    unsigned char wire_i[2*sizeof(uint32_t)];
+    storeWireLongInt(wire_i, i);
+    countTraffic(sent_traffic, TRAFFIC_LONG_INT, sizeof(wire_i));
+    struct iovec iov;
+    iov.iov_base = wire_i;
+    iov.iov_len = sizeof(wire_i);
+    sendVector(fd, &iov, 1);
+}
+
 /**
  * @brief Sends the specified string through the file
  *  with the given file descriptor, using the given buffer with the specified size.
@@ -194,6 +707,7 @@ void sendString(int fd, const char *string, char *buffer, unsigned int buffer_si
 {
     unsigned int len = strlen(string) + 1;
     sendInt(fd, len, buffer, buffer_size);
+    countTraffic(sent_traffic, TRAFFIC_STRING, len);
     unsigned int bytes_to_write, bytes_left;
     int written;
     for (unsigned long sent_bytes = 0; sent_bytes < len; sent_bytes += bytes_to_write)
@@ -236,36 +750,55 @@ void sendString(int fd, const char *string, char *buffer, unsigned int buffer_si
  */
 void sendDate(int fd, const Date &date, char *buffer, unsigned int buffer_size)
 {
+    countTraffic(sent_traffic, TRAFFIC_DATE, 0);
     sendShortInt(fd, date.day, buffer, buffer_size);
     sendShortInt(fd, date.month, buffer, buffer_size);
     sendShortInt(fd, date.year, buffer, buffer_size);
 }
 
 /**
- * @brief Reads a string from the file with the given file descriptor,
- * using the given buffer with the specified size, and stores it in a heap character array
- * pointed by the given string pointer. The pointer must be free-ed after use.
+ * @brief Sends the buckets and the latency sum of the specified Latency Histogram through the file
+ *  with the given file descriptor (as 64-bit integers, with a single writev() call).
  * 
- * @param fd The file descriptor of the file to read data from.
- * @param string This will point to the received data.
- * @param buffer The buffer to store newly received data from the file.
- * @param buffer_size The size of the buffer.
+ * @param fd The file descriptor of the file to write the data.
+ * @param histogram The Latency Histogram to send.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size Not used (kept for compatibility with the rest of the routines).
  */
-void receiveString(int fd, char *&string, char *buffer, unsigned int buffer_size)
+void sendLatencyHistogram(int fd, const LatencyHistogram &histogram, char *buffer, unsigned int buffer_size)
 {
-    unsigned int string_length;
-    receiveInt(fd, string_length, buffer, buffer_size);
-    string = (char*)malloc(string_length);
-    if (string == NULL)
+    unsigned char wire_histogram[(LATENCY_BUCKETS + 1)*2*sizeof(uint32_t)];
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++)
     {
-        perror("Failed malloc() call.\n");
-        exit(EXIT_FAILURE);
+        storeWireLongInt(wire_histogram + i*2*sizeof(uint32_t), histogram.getBucket(i));
     }
-    unsigned long curr_string_size = 0, received_bytes, bytes_to_read, bytes_left = string_length;
-    while (bytes_left > 0)
+    storeWireLongInt(wire_histogram + LATENCY_BUCKETS*2*sizeof(uint32_t), histogram.getTotalMicros());
+    countTraffic(sent_traffic, TRAFFIC_HISTOGRAM, sizeof(wire_histogram));
+    struct iovec iov;
+    iov.iov_base = wire_histogram;
+    iov.iov_len = sizeof(wire_histogram);
+    sendVector(fd, &iov, 1);
+}
+
+/**
+ * @brief Reads the specified number of bytes from the file with the given file descriptor,
+ * and stores them directly in data (no intermediate buffer is used).
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param data The received bytes will be stored here.
+ * @param len The number of bytes to read.
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ */
+static void receiveBytes(int fd, void *data, unsigned long len, unsigned int buffer_size)
+{
+    unsigned int bytes_to_read;
+    unsigned long bytes_left;
+    int received_bytes;
+    for(unsigned long total_bytes = 0; total_bytes < len; total_bytes += received_bytes)
     {
+        bytes_left = len - total_bytes;
         bytes_to_read = bytes_left < buffer_size ? bytes_left : buffer_size;
-        received_bytes = read(fd, buffer, bytes_to_read);
+        received_bytes = read(fd, static_cast<char*>(data) + total_bytes, bytes_to_read);
         if (received_bytes < 0)
         {
             if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
@@ -278,188 +811,415 @@ void receiveString(int fd, char *&string, char *buffer, unsigned int buffer_size
                 exit(EXIT_FAILURE);
             }
         }
-        else
+    }
+}
+
+/**
+ * @brief Reads a string from the file with the given file descriptor,
+ * and stores it in a heap character array pointed by the given string pointer.
+ * The pointer must be free-ed after use.
+ * 
+ * The string bytes are read directly in the heap array.
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param string This will point to the received data.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ */
+void receiveString(int fd, char *&string, char *buffer, unsigned int buffer_size)
+{
+    unsigned int string_length;
+    receiveInt(fd, string_length, buffer, buffer_size);
+    string = (char*)malloc(string_length + 1);
+    if (string == NULL)
+    {
+        perror("Failed malloc() call.\n");
+        exit(EXIT_FAILURE);
+    }
+    receiveBytes(fd, string, string_length, buffer_size);
+    countTraffic(received_traffic, TRAFFIC_STRING, string_length);
+    // In case something went wrong...
+    string[string_length] = '\0';
+}
+
+/**
+ * Returns TRUE if the given encoded payload (see encodeBloomFilter) of a Bloom Filter with filter_size bytes
+ * is well-formed, i.e. every count in it fits in the payload, and every word it refers to is inside the filter.
+ * Otherwise (e.g. the message was truncated or corrupted) FALSE is returned.
+ */
+static bool isValidEncoding(const unsigned char *payload, unsigned long payload_size, char encoding,
+                            unsigned long filter_size)
+{
+    unsigned long filter_words = (filter_size + BLOOM_WORD_SIZE - 1) / BLOOM_WORD_SIZE;
+    if (filter_size == 0) { return false; }
+    if (encoding == BLOOM_ENCODING_RAW)
+    {
+        return payload_size == filter_size;
+    }
+    if ((encoding != BLOOM_ENCODING_SPARSE && encoding != BLOOM_ENCODING_RLE) || payload_size < sizeof(uint32_t))
+    {
+        return false;
+    }
+    unsigned long count = loadWireInt(payload);
+    unsigned long pos = sizeof(uint32_t);
+    if (encoding == BLOOM_ENCODING_SPARSE)
+    {
+        if (count != (payload_size - pos) / (sizeof(uint32_t) + BLOOM_WORD_SIZE) ||
+            (payload_size - pos) % (sizeof(uint32_t) + BLOOM_WORD_SIZE) != 0)
         {
-            memcpy(string + curr_string_size, buffer, received_bytes);
+            return false;
         }
-        bytes_left -= received_bytes;
-        curr_string_size += received_bytes;
+        for (unsigned long i = 0; i < count; i++)
+        {
+            if (loadWireInt(payload + pos) >= filter_words) { return false; }
+            pos += sizeof(uint32_t) + BLOOM_WORD_SIZE;
+        }
+        return true;
     }
-    if (string[string_length - 1] != '\0')
-    // In case something went wrong...
+    // Run-length encoding: every (zero words, literal words) pair must be followed by its literal words
+    unsigned long word = 0;
+    for (unsigned long i = 0; i < count; i++)
     {
-        string[string_length - 1] = '\0';
+        if (payload_size - pos < 2*sizeof(uint32_t)) { return false; }
+        unsigned long zero_words = loadWireInt(payload + pos);
+        unsigned long literal_words = loadWireInt(payload + pos + sizeof(uint32_t));
+        pos += 2*sizeof(uint32_t);
+        if (zero_words > filter_words - word) { return false; }
+        word += zero_words;
+        if (literal_words > filter_words - word || literal_words > (payload_size - pos) / BLOOM_WORD_SIZE)
+        {
+            return false;
+        }
+        word += literal_words;
+        pos += literal_words*BLOOM_WORD_SIZE;
     }
+    return pos == payload_size;
 }
 
 /**
- * @brief Reads a Bloom Filter byte array from the file with the given file descriptor,
- * using the given buffer with the specified size, and "updates" the byte array of the given Bloom Filter
- * using bitwise-OR.
- * 
- * @param fd The file descriptor of the file to read data from.
- * @param filter The Bloom Filter to be updated based on the received data.
- * @param buffer The buffer to store newly received data from the file.
- * @param buffer_size The size of the buffer.
+ * Merges the given encoded payload (see encodeBloomFilter) of a Bloom Filter with filter_size bytes
+ * in the specified Bloom Filter, using bitwise-OR.
+ * The payload may belong to a larger filter that can be folded in the specified one (see BloomFilter::canFold).
+ *
+ * @returns TRUE if the payload was merged, FALSE if it is not well-formed (see isValidEncoding),
+ * in which case the filter is not modified.
  */
-void updateBloomFilter(int fd, BloomFilter *filter, char *buffer, unsigned int buffer_size)
+static bool decodeBloomFilter(const unsigned char *payload, unsigned long payload_size, char encoding,
+                              unsigned long filter_size, BloomFilter *filter)
 {
-    unsigned int bytes_to_read, bytes_left;
-    int received_bytes;
-    for(unsigned long int total_bytes = 0; total_bytes < filter->numBytes; total_bytes += received_bytes)
+    if (!isValidEncoding(payload, payload_size, encoding, filter_size))
     {
-        bytes_left = filter->numBytes - total_bytes;
-        bytes_to_read = bytes_left < buffer_size ? bytes_left : buffer_size;
-        received_bytes = read(fd, buffer, bytes_to_read);
-        if (received_bytes < 0)
-        {
-            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+        return false;
+    }
+    const unsigned char *pos = payload;
+    unsigned int count;
+    switch (encoding)
+    {
+        case BLOOM_ENCODING_RAW:
+            filter->mergeFolded(payload, 0, payload_size);
+            break;
+        case BLOOM_ENCODING_SPARSE:
+            count = loadWireInt(pos);
+            pos += sizeof(uint32_t);
+            for (unsigned int i = 0; i < count; i++)
             {
-                received_bytes = 0;
+                unsigned long word = loadWireInt(pos);
+                pos += sizeof(uint32_t);
+                filter->mergeFolded(pos, word*BLOOM_WORD_SIZE, BLOOM_WORD_SIZE);
+                pos += BLOOM_WORD_SIZE;
             }
-            else
-            {
-                perror("Fatal error while reading from file.\n");
-                exit(EXIT_FAILURE);
-            }            
-        }
-        else
+            break;
+        case BLOOM_ENCODING_RLE:
         {
-            for (int i = 0; i < received_bytes; i++)
+            unsigned long word = 0;
+            count = loadWireInt(pos);
+            pos += sizeof(uint32_t);
+            for (unsigned int i = 0; i < count; i++)
             {
-                filter->bits[total_bytes + i] = filter->bits[total_bytes + i] | buffer[i]; 
+                word += loadWireInt(pos);
+                unsigned long literal_words = loadWireInt(pos + sizeof(uint32_t));
+                pos += 2*sizeof(uint32_t);
+                filter->mergeFolded(pos, word*BLOOM_WORD_SIZE, literal_words*BLOOM_WORD_SIZE);
+                pos += literal_words*BLOOM_WORD_SIZE;
+                word += literal_words;
             }
+            break;
         }
+        default:
+            // Should never be reached, or something is wrong
+            break;
     }
+    return true;
 }
 
 /**
- * @brief Reads a Message Type from the file with the given file descriptor,
- * using the given buffer with the specified size, and stores it in the given char variable.
+ * Reads the header and the encoded payload of a Bloom Filter (stage) from the file with the given file descriptor.
+ * The parameters of the sent filter are stored in filter_size & num_hashes,
+ * and the number of bytes read is added to received_bytes.
+ *
+ * @returns A heap array with the encoded payload (to be decoded with decodeBloomFilter), which must be deleted after use.
+ */
+static unsigned char* receiveEncodedBloomFilter(int fd, unsigned int buffer_size, char &encoding,
+                                                unsigned long &filter_size, unsigned int &num_hashes, unsigned long &payload_size,
+                                                unsigned long long &received_bytes)
+{
+    unsigned char header[BLOOM_HEADER_SIZE];
+    receiveBytes(fd, header, sizeof(header), buffer_size);
+    encoding = header[0];
+    filter_size = loadWireInt(header + sizeof(char));
+    num_hashes = header[sizeof(char) + sizeof(uint32_t)];
+    payload_size = loadWireInt(header + 2*sizeof(char) + sizeof(uint32_t));
+
+    unsigned char *payload = new unsigned char[payload_size];
+    receiveBytes(fd, payload, payload_size, buffer_size);
+    received_bytes += sizeof(header) + payload_size;
+    return payload;
+}
+
+/**
+ * Reads the number of stages of a Scalable Bloom Filter from the file with the given file descriptor.
+ */
+static unsigned int receiveNumStages(int fd, unsigned int buffer_size)
+{
+    unsigned char header[sizeof(uint32_t)];
+    receiveBytes(fd, header, sizeof(header), buffer_size);
+    return loadWireInt(header);
+}
+
+/**
+ * @brief Reads a Scalable Bloom Filter from the file with the given file descriptor,
+ * and "updates" the stages of the given Scalable Bloom Filter using bitwise-OR.
+ * 
+ * The byte array of each stage may have been sent using any of the available encodings (see sendBloomFilter).
+ * The encoded payload is read directly in a scratch array, which is then merged with the stage.
+ * Each sent stage is merged only if it can be folded in the respective stage (see BloomFilter::canFold)
+ * and its payload is well-formed (see isValidEncoding), otherwise it is discarded. Sent stages that the given filter does not have are appended to it
+ * (unless a previous stage was discarded).
  * 
  * @param fd The file descriptor of the file to read data from.
- * @param req_type The variable to store the received Message Type.
- * @param buffer The buffer to store newly received data from the file.
- * @param buffer_size The size of the buffer.
+ * @param filter The Scalable Bloom Filter to be updated based on the received data.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ * 
+ * @returns TRUE if all the sent stages were merged, FALSE if any of them was discarded.
  */
-void receiveMessageType(int fd, char &req_type, char *buffer, unsigned int buffer_size)
+bool updateBloomFilter(int fd, ScalableBloomFilter *filter, char *buffer, unsigned int buffer_size)
 {
-    unsigned int bytes_to_read, bytes_left;
-    int received_bytes;
-    for(unsigned long total_bytes = 0; total_bytes < sizeof(char); total_bytes += received_bytes)
+    unsigned int num_stages = receiveNumStages(fd, buffer_size);
+    unsigned long long received_bytes = sizeof(uint32_t);
+    bool compatible = true;
+    for (unsigned int i = 0; i < num_stages; i++)
     {
-        bytes_left = sizeof(char) - total_bytes;
-        bytes_to_read = bytes_left < buffer_size ? bytes_left : buffer_size;
-        received_bytes = read(fd, buffer, bytes_to_read);
-        if (received_bytes < 0)
+        char encoding;
+        unsigned long filter_size, payload_size;
+        unsigned int num_hashes;
+        unsigned char *payload = receiveEncodedBloomFilter(fd, buffer_size, encoding, filter_size, num_hashes, payload_size,
+                                                           received_bytes);
+        if (i < filter->getNumStages())
         {
-            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+            if (!filter->getStage(i)->canFold(filter_size, num_hashes) ||
+                !decodeBloomFilter(payload, payload_size, encoding, filter_size, filter->getStage(i)))
             {
-                received_bytes = 0;
+                compatible = false;
             }
-            else
-            {
-                perror("Fatal error while reading from file.\n");
-                exit(EXIT_FAILURE);
-            }          
+        }
+        else if (compatible && num_hashes >= 1 && num_hashes <= K_MAX &&
+                 isValidEncoding(payload, payload_size, encoding, filter_size))
+        // A stage that was added after the filter was last received
+        {
+            BloomFilter *stage = new BloomFilter(filter_size, false, num_hashes);
+            decodeBloomFilter(payload, payload_size, encoding, filter_size, stage);
+            filter->appendStage(stage);
         }
         else
         {
-            memcpy(&req_type + total_bytes, buffer, received_bytes);
+            compatible = false;
         }
+        delete[] payload;
     }
+    countTraffic(received_traffic, TRAFFIC_BLOOM_FILTER, received_bytes);
+    return compatible;
 }
 
 /**
- * @brief Reads an integer from the file with the given file descriptor,
- * using the given buffer with the specified size, and stores it in the given integer variable.
+ * @brief Reads a Scalable Bloom Filter from the file with the given file descriptor,
+ * and stores it in a new Scalable Bloom Filter, whose stages have the sent sizes & numbers of Hash Functions.
  * 
  * @param fd The file descriptor of the file to read data from.
- * @param i The variable to store the received integer
- * @param buffer The buffer to store newly received data from the file.
- * @param buffer_size The size of the buffer.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ * 
+ * @returns The new Scalable Bloom Filter, which must be deleted after use, or NULL if the received filter
+ * was not valid (e.g. a stage payload was truncated or corrupted, see isValidEncoding) or had no stages.
  */
-void receiveInt(int fd, unsigned int &i, char *buffer, unsigned int buffer_size)
+ScalableBloomFilter* receiveBloomFilter(int fd, char *buffer, unsigned int buffer_size)
 {
-    uint32_t net_i;
-    unsigned int bytes_to_read, bytes_left;
-    int received_bytes;
-    for(unsigned long total_bytes = 0; total_bytes < sizeof(unsigned int); total_bytes += received_bytes)
+    unsigned int num_stages = receiveNumStages(fd, buffer_size);
+    unsigned long long received_bytes = sizeof(uint32_t);
+    ScalableBloomFilter *filter = NULL;
+    bool valid = true;
+    for (unsigned int i = 0; i < num_stages; i++)
     {
-        bytes_left = sizeof(unsigned int) - total_bytes;
-        bytes_to_read = bytes_left < buffer_size ? bytes_left : buffer_size;
-        received_bytes = read(fd, buffer, bytes_to_read);
-        if (received_bytes < 0)
+        char encoding;
+        unsigned long filter_size, payload_size;
+        unsigned int num_hashes;
+        unsigned char *payload = receiveEncodedBloomFilter(fd, buffer_size, encoding, filter_size, num_hashes, payload_size,
+                                                           received_bytes);
+        if (valid && num_hashes >= 1 && num_hashes <= K_MAX && isValidEncoding(payload, payload_size, encoding, filter_size))
         {
-            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+            BloomFilter *stage = new BloomFilter(filter_size, false, num_hashes);
+            decodeBloomFilter(payload, payload_size, encoding, filter_size, stage);
+            if (filter == NULL)
             {
-                received_bytes = 0;
+                filter = new ScalableBloomFilter(stage);
             }
             else
             {
-                perror("Fatal error while reading from file.\n");
-                exit(EXIT_FAILURE);
-            }          
+                filter->appendStage(stage);
+            }
         }
         else
+        // The rest of the stages are still read, so that the next message can be received
         {
-            memcpy((char*)&net_i + total_bytes, buffer, received_bytes);
+            valid = false;
         }
+        delete[] payload;
     }
+    countTraffic(received_traffic, TRAFFIC_BLOOM_FILTER, received_bytes);
+    if (!valid || filter == NULL)
+    {
+        delete filter;
+        return NULL;
+    }
+    return filter;
+}
+
+/**
+ * @brief Reads a serialized Roaring Bitmap from the file with the given file descriptor,
+ * and adds all of its values in the given Roaring Bitmap.
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param bitmap The Roaring Bitmap to be updated based on the received data.
+ * @param value_offset Added to each received value (a multiple of 2^16, see RoaringBitmap::mergeSerialized).
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ * 
+ * @returns TRUE if the received bitmap was valid, FALSE otherwise.
+ */
+bool updateIdBitmap(int fd, RoaringBitmap *bitmap, uint32_t value_offset, char *buffer, unsigned int buffer_size)
+{
+    unsigned char header[sizeof(uint32_t)];
+    receiveBytes(fd, header, sizeof(header), buffer_size);
+    unsigned long payload_size = loadWireInt(header);
+    unsigned char *payload = new unsigned char[payload_size];
+    receiveBytes(fd, payload, payload_size, buffer_size);
+    countTraffic(received_traffic, TRAFFIC_ID_BITMAP, sizeof(header) + payload_size);
+
+    bool valid = bitmap->mergeSerialized(payload, payload_size, value_offset);
+    delete[] payload;
+    return valid;
+}
+
+/**
+ * @brief Reads a Message Type from the file with the given file descriptor,
+ * and stores it in the given char variable.
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param req_type The variable to store the received Message Type.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ */
+void receiveMessageType(int fd, char &req_type, char *buffer, unsigned int buffer_size)
+{
+    receiveBytes(fd, &req_type, sizeof(char), buffer_size);
+    countTraffic(received_traffic, TRAFFIC_MESSAGE_TYPE, sizeof(char));
+}
+
+/**
+ * @brief Reads an integer from the file with the given file descriptor,
+ * and stores it in the given integer variable.
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param i The variable to store the received integer
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ */
+void receiveInt(int fd, unsigned int &i, char *buffer, unsigned int buffer_size)
+{
+    uint32_t net_i;
+    receiveBytes(fd, &net_i, sizeof(uint32_t), buffer_size);
+    countTraffic(received_traffic, TRAFFIC_INT, sizeof(uint32_t));
     i = ntohl(net_i);
 }
 
 /**
  * @brief Reads a short integer from the file with the given file descriptor,
- * using the given buffer with the specified size, and stores it in the given short integer variable.
+ * and stores it in the given short integer variable.
  * 
  * @param fd The file descriptor of the file to read data from.
  * @param i The variable to store the received short integer
- * @param buffer The buffer to store newly received data from the file.
- * @param buffer_size The size of the buffer.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
  */
 void receiveShortInt(int fd, unsigned short int &i, char *buffer, unsigned int buffer_size)
 {
     uint16_t net_i;
-    unsigned int bytes_to_read, bytes_left;
-    int received_bytes;
-    for(unsigned long total_bytes = 0; total_bytes < sizeof(unsigned short int); total_bytes += received_bytes)
-    {
-        bytes_left = sizeof(unsigned short int) - total_bytes;
-        bytes_to_read = bytes_left < buffer_size ? bytes_left : buffer_size;
-        received_bytes = read(fd, buffer, bytes_to_read);
-        if (received_bytes < 0)
-        {
-            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                received_bytes = 0;
-            }
-            else
-            {
-                perror("Fatal error while reading from file.\n");
-                exit(EXIT_FAILURE);
-            }
-        }
-        else
-        {
-            memcpy((char*)&net_i + total_bytes, buffer, received_bytes);
-        }
-    }
+    receiveBytes(fd, &net_i, sizeof(uint16_t), buffer_size);
+    countTraffic(received_traffic, TRAFFIC_SHORT_INT, sizeof(uint16_t));
     i = ntohs(net_i);
 }
 
+/**
+ * @brief Reads a 64-bit integer from the file with the given file descriptor,
+ * and stores it in the given integer variable.
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param i The variable to store the received integer
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ */
+void receiveLongInt(int fd, unsigned long long &i, char *buffer, unsigned int buffer_size)
+{
+    unsigned char wire_i[2*sizeof(uint32_t)];
+    receiveBytes(fd, wire_i, sizeof(wire_i), buffer_size);
+    countTraffic(received_traffic, TRAFFIC_LONG_INT, sizeof(wire_i));
+    i = loadWireLongInt(wire_i);
+}
+
 /**
  * @brief Reads a Date from the file with the given file descriptor,
- * using the given buffer with the specified size, and stores it in the specified Date object.
+ * and stores it in the specified Date object.
  * 
  * @param fd The file descriptor of the file to read data from.
  * @param date The date object to store the received date.
- * @param buffer The buffer to store newly received data from the file.
- * @param buffer_size The size of the buffer.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
  */
 void receiveDate(int fd, Date &date, char *buffer, unsigned int buffer_size)
 {
+    countTraffic(received_traffic, TRAFFIC_DATE, 0);
     receiveShortInt(fd, date.day, buffer, buffer_size);
     receiveShortInt(fd, date.month, buffer, buffer_size);
     receiveShortInt(fd, date.year, buffer, buffer_size);
 }
+
+/**
+ * @brief Reads a Latency Histogram from the file with the given file descriptor,
+ * and adds its buckets and latency sum to the given Latency Histogram.
+ * 
+ * @param fd The file descriptor of the file to read data from.
+ * @param histogram The Latency Histogram to be updated based on the received data.
+ * @param buffer Not used (kept for compatibility with the rest of the routines).
+ * @param buffer_size The maximum number of bytes to read with a single read() call.
+ */
+void updateLatencyHistogram(int fd, LatencyHistogram &histogram, char *buffer, unsigned int buffer_size)
+{
+    unsigned char wire_histogram[(LATENCY_BUCKETS + 1)*2*sizeof(uint32_t)];
+    receiveBytes(fd, wire_histogram, sizeof(wire_histogram), buffer_size);
+    countTraffic(received_traffic, TRAFFIC_HISTOGRAM, sizeof(wire_histogram));
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        histogram.addBucket(i, loadWireLongInt(wire_histogram + i*2*sizeof(uint32_t)));
+    }
+    histogram.addTotal(loadWireLongInt(wire_histogram + LATENCY_BUCKETS*2*sizeof(uint32_t)));
+}
@@ -0,0 +1,437 @@
+/**
+ * File: roaring_bitmap.cpp
+ * Roaring Bitmap class implementation.
+ * Pavlos Spanoudakis (sdi1800184)
+ *
+ * Serialized bitmaps have the following (big-endian) format:
+ *
+ *   <number of containers (4 bytes)>
+ *   { <key (2)> <type (1)> <cardinality - 1 (2)> <values (2 bytes each) | bitset words (8 bytes each)> }
+ */
+
+#include <cstring>
+#include "../include/roaring_bitmap.hpp"
+
+/**
+ * Stores the lowest num_bytes bytes of value at the given address, most significant byte first.
+ * @returns The address after the stored bytes.
+ */
+static unsigned char* storeBigEndian(unsigned char *dest, uint64_t value, unsigned int num_bytes)
+{
+    for (unsigned int i = num_bytes; i > 0; i--)
+    {
+        dest[i - 1] = value & 0xFF;
+        value >>= 8;
+    }
+    return dest + num_bytes;
+}
+
+/**
+ * Returns the num_bytes bytes stored at the given address, most significant byte first.
+ */
+static uint64_t loadBigEndian(const unsigned char *src, unsigned int num_bytes)
+{
+    uint64_t value = 0;
+    for (unsigned int i = 0; i < num_bytes; i++)
+    {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+RoaringContainer::RoaringContainer(uint16_t container_key):
+values(NULL), capacity(0), words(NULL), key(container_key), cardinality(0), changed(false) { }
+
+RoaringContainer::~RoaringContainer()
+{
+    delete[] values;
+    delete[] words;
+}
+
+/**
+ * Searches for the specified value in the (array) container using binary search.
+ * @returns 1 if the value was found, 0 otherwise. pos is set to the position of the value
+ * (or the position where it should be inserted, if it was not found).
+ */
+int RoaringContainer::findValue(uint16_t value, unsigned int &pos) const
+{
+    unsigned int low = 0, high = this->cardinality;
+    while (low < high)
+    {
+        unsigned int mid = low + (high - low) / 2;
+        if (this->values[mid] == value)
+        {
+            pos = mid;
+            return 1;
+        }
+        (value < this->values[mid]) ? (high = mid) : (low = mid + 1);
+    }
+    pos = low;
+    return 0;
+}
+
+/**
+ * Inserts the specified value at the given position of the (array) container, expanding the array if needed.
+ */
+void RoaringContainer::insertAt(unsigned int pos, uint16_t value)
+{
+    if (this->cardinality == this->capacity)
+    {
+        this->capacity = (this->capacity == 0) ? 4 : this->capacity * 2;
+        uint16_t *new_values = new uint16_t[this->capacity];
+        if (this->values != NULL)
+        {
+            memcpy(new_values, this->values, this->cardinality * sizeof(uint16_t));
+            delete[] this->values;
+        }
+        this->values = new_values;
+    }
+    memmove(this->values + pos + 1, this->values + pos, (this->cardinality - pos) * sizeof(uint16_t));
+    this->values[pos] = value;
+    this->cardinality++;
+}
+
+/**
+ * Converts the (array) container to a bitset container.
+ */
+void RoaringContainer::toBitset()
+{
+    this->words = new uint64_t[ROARING_BITSET_WORDS];
+    memset(this->words, 0, ROARING_BITSET_WORDS * sizeof(uint64_t));
+    for (unsigned int i = 0; i < this->cardinality; i++)
+    {
+        this->words[this->values[i] >> 6] |= (uint64_t)1 << (this->values[i] & 63);
+    }
+    delete[] this->values;
+    this->values = NULL;
+    this->capacity = 0;
+}
+
+/**
+ * Adds the specified (16-bit) value in the container.
+ * Array containers are converted to bitset containers when they exceed ROARING_ARRAY_MAX values.
+ * @returns TRUE if the value was added, FALSE if it was already present.
+ */
+bool RoaringContainer::add(uint16_t value)
+{
+    if (this->words == NULL)
+    {
+        unsigned int pos;
+        if (findValue(value, pos)) { return false; }
+        if (this->cardinality < ROARING_ARRAY_MAX)
+        {
+            insertAt(pos, value);
+            this->changed = true;
+            return true;
+        }
+        toBitset();
+    }
+    uint64_t mask = (uint64_t)1 << (value & 63);
+    if (this->words[value >> 6] & mask) { return false; }
+    this->words[value >> 6] |= mask;
+    this->cardinality++;
+    this->changed = true;
+    return true;
+}
+
+/**
+ * Returns TRUE if the specified (16-bit) value is present in the container, FALSE otherwise.
+ */
+bool RoaringContainer::contains(uint16_t value) const
+{
+    if (this->words != NULL)
+    {
+        return (this->words[value >> 6] >> (value & 63)) & 1;
+    }
+    unsigned int pos;
+    return findValue(value, pos);
+}
+
+/**
+ * Returns the type of the container (ROARING_ARRAY or ROARING_BITSET).
+ */
+char RoaringContainer::getType() const
+{
+    return (this->words == NULL) ? ROARING_ARRAY : ROARING_BITSET;
+}
+
+/**
+ * Returns the memory (in bytes) used for storing the values of the container.
+ */
+unsigned long RoaringContainer::getNumBytes() const
+{
+    return (this->words == NULL) ? this->capacity * sizeof(uint16_t) : ROARING_BITSET_WORDS * sizeof(uint64_t);
+}
+
+/**
+ * Returns the number of bytes needed to serialize the container (including its header).
+ */
+unsigned long RoaringContainer::serializedSize() const
+{
+    return ROARING_CONTAINER_HEADER +
+           ((this->words == NULL) ? this->cardinality * sizeof(uint16_t) : ROARING_BITSET_WORDS * sizeof(uint64_t));
+}
+
+/**
+ * Serializes the (non-empty) container at the given address.
+ * @returns The address after the serialized container.
+ */
+unsigned char* RoaringContainer::serialize(unsigned char *dest) const
+{
+    dest = storeBigEndian(dest, this->key, sizeof(uint16_t));
+    *dest++ = getType();
+    dest = storeBigEndian(dest, this->cardinality - 1, sizeof(uint16_t));
+    if (this->words == NULL)
+    {
+        for (unsigned int i = 0; i < this->cardinality; i++)
+        {
+            dest = storeBigEndian(dest, this->values[i], sizeof(uint16_t));
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < ROARING_BITSET_WORDS; i++)
+        {
+            dest = storeBigEndian(dest, this->words[i], sizeof(uint64_t));
+        }
+    }
+    return dest;
+}
+
+/**
+ * Adds the values of the serialized container (without its header) at the given address, with the specified
+ * type & cardinality, in this container. Bitset containers are merged using bitwise-OR.
+ * @returns The address after the serialized container.
+ */
+const unsigned char* RoaringContainer::mergeSerialized(const unsigned char *src, char type, unsigned int count)
+{
+    if (type == ROARING_ARRAY)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            add(loadBigEndian(src, sizeof(uint16_t)));
+            src += sizeof(uint16_t);
+        }
+        return src;
+    }
+    if (this->words == NULL)
+    {
+        toBitset();
+    }
+    unsigned int new_cardinality = 0;
+    for (unsigned int i = 0; i < ROARING_BITSET_WORDS; i++)
+    {
+        this->words[i] |= loadBigEndian(src, sizeof(uint64_t));
+        new_cardinality += __builtin_popcountll(this->words[i]);
+        src += sizeof(uint64_t);
+    }
+    if (new_cardinality != this->cardinality)
+    {
+        this->cardinality = new_cardinality;
+        this->changed = true;
+    }
+    return src;
+}
+
+RoaringBitmap::RoaringBitmap(): containers(NULL), numContainers(0), capacity(0) { }
+
+RoaringBitmap::~RoaringBitmap()
+{
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        delete this->containers[i];
+    }
+    delete[] this->containers;
+}
+
+/**
+ * Searches for the container with the specified key using binary search.
+ * @returns 1 if the container was found, 0 otherwise. pos is set to the position of the container
+ * (or the position where it should be inserted, if it was not found).
+ */
+int RoaringBitmap::findContainer(uint16_t key, unsigned int &pos) const
+{
+    unsigned int low = 0, high = this->numContainers;
+    while (low < high)
+    {
+        unsigned int mid = low + (high - low) / 2;
+        if (this->containers[mid]->key == key)
+        {
+            pos = mid;
+            return 1;
+        }
+        (key < this->containers[mid]->key) ? (high = mid) : (low = mid + 1);
+    }
+    pos = low;
+    return 0;
+}
+
+/**
+ * Returns the container with the specified key, which is created (and inserted in order) if it does not exist.
+ */
+RoaringContainer* RoaringBitmap::getOrCreateContainer(uint16_t key)
+{
+    unsigned int pos;
+    if (findContainer(key, pos))
+    {
+        return this->containers[pos];
+    }
+    if (this->numContainers == this->capacity)
+    {
+        this->capacity = (this->capacity == 0) ? 2 : this->capacity * 2;
+        RoaringContainer **new_containers = new RoaringContainer*[this->capacity];
+        if (this->containers != NULL)
+        {
+            memcpy(new_containers, this->containers, this->numContainers * sizeof(RoaringContainer*));
+            delete[] this->containers;
+        }
+        this->containers = new_containers;
+    }
+    memmove(this->containers + pos + 1, this->containers + pos, (this->numContainers - pos) * sizeof(RoaringContainer*));
+    this->containers[pos] = new RoaringContainer(key);
+    this->numContainers++;
+    return this->containers[pos];
+}
+
+/**
+ * Adds the specified value in the bitmap.
+ * @returns TRUE if the value was added, FALSE if it was already present.
+ */
+bool RoaringBitmap::add(uint32_t value)
+{
+    return getOrCreateContainer(value >> 16)->add(value & 0xFFFF);
+}
+
+/**
+ * Returns TRUE if the specified value is present in the bitmap, FALSE otherwise.
+ */
+bool RoaringBitmap::contains(uint32_t value) const
+{
+    unsigned int pos;
+    return findContainer(value >> 16, pos) && this->containers[pos]->contains(value & 0xFFFF);
+}
+
+/**
+ * Returns the number of values in the bitmap.
+ */
+unsigned long RoaringBitmap::getCardinality() const
+{
+    unsigned long total = 0;
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        total += this->containers[i]->cardinality;
+    }
+    return total;
+}
+
+unsigned int RoaringBitmap::getNumContainers() const
+{
+    return this->numContainers;
+}
+
+/**
+ * Returns the number of containers that are stored as sorted arrays.
+ */
+unsigned int RoaringBitmap::getNumArrayContainers() const
+{
+    unsigned int total = 0;
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        total += (this->containers[i]->getType() == ROARING_ARRAY);
+    }
+    return total;
+}
+
+/**
+ * Returns the memory (in bytes) used for storing the values of all the containers.
+ */
+unsigned long RoaringBitmap::getNumBytes() const
+{
+    unsigned long total = 0;
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        total += this->containers[i]->getNumBytes();
+    }
+    return total;
+}
+
+/**
+ * Returns TRUE if values have been added in the bitmap since the last clearChanges() call, FALSE otherwise.
+ */
+bool RoaringBitmap::hasChanges() const
+{
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        if (this->containers[i]->changed) { return true; }
+    }
+    return false;
+}
+
+/**
+ * Marks all the containers as unchanged.
+ */
+void RoaringBitmap::clearChanges()
+{
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        this->containers[i]->changed = false;
+    }
+}
+
+/**
+ * Returns the number of bytes needed to serialize the bitmap (see serialize).
+ */
+unsigned long RoaringBitmap::serializedSize(bool changes_only) const
+{
+    unsigned long total = sizeof(uint32_t);
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        if (this->containers[i]->cardinality == 0 || (changes_only && !this->containers[i]->changed)) { continue; }
+        total += this->containers[i]->serializedSize();
+    }
+    return total;
+}
+
+/**
+ * Serializes the bitmap at the given address, which must have serializedSize(changes_only) bytes.
+ * If changes_only is TRUE, only the containers that have changed since clearChanges() are serialized
+ * (the receiver must already have the rest, see mergeSerialized).
+ */
+void RoaringBitmap::serialize(unsigned char *dest, bool changes_only) const
+{
+    unsigned char *count_pos = dest;
+    uint32_t count = 0;
+    dest += sizeof(uint32_t);
+    for (unsigned int i = 0; i < this->numContainers; i++)
+    {
+        if (this->containers[i]->cardinality == 0 || (changes_only && !this->containers[i]->changed)) { continue; }
+        dest = this->containers[i]->serialize(dest);
+        count++;
+    }
+    storeBigEndian(count_pos, count, sizeof(uint32_t));
+}
+
+/**
+ * Adds all the values of the serialized bitmap (see serialize) with the specified size in this bitmap,
+ * increased by value_offset, which must be a multiple of 2^16 (so that whole containers are shifted).
+ * @returns TRUE if the serialized bitmap was valid, FALSE otherwise (in which case it may have been partially merged).
+ */
+bool RoaringBitmap::mergeSerialized(const unsigned char *src, unsigned long size, uint32_t value_offset)
+{
+    const unsigned char *end = src + size;
+    if (size < sizeof(uint32_t)) { return false; }
+    uint32_t count = loadBigEndian(src, sizeof(uint32_t));
+    src += sizeof(uint32_t);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (end - src < ROARING_CONTAINER_HEADER) { return false; }
+        uint16_t key = loadBigEndian(src, sizeof(uint16_t));
+        char type = src[sizeof(uint16_t)];
+        unsigned int cardinality = loadBigEndian(src + sizeof(uint16_t) + 1, sizeof(uint16_t)) + 1;
+        src += ROARING_CONTAINER_HEADER;
+        unsigned long payload = (type == ROARING_ARRAY) ? cardinality * sizeof(uint16_t) : ROARING_BITSET_WORDS * sizeof(uint64_t);
+        if ((type != ROARING_ARRAY && type != ROARING_BITSET) || (unsigned long)(end - src) < payload) { return false; }
+        src = getOrCreateContainer(key + (value_offset >> 16))->mergeSerialized(src, type, cardinality);
+    }
+    return src == end;
+}
@@ -0,0 +1,220 @@
+/**
+ * File: scalable_bloom_filter.cpp
+ * Scalable Bloom Filter class implementation.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#include <cmath>
+#include "../include/scalable_bloom_filter.hpp"
+
+/**
+ * Create a Scalable Bloom Filter, with a first stage of n bytes size, which uses k Hash Functions.
+ * New stages are added when the last one reaches its capacity, up to max_stage_bytes each.
+ * If max_stage_bytes is 0, no stages are added on insertion (they can only be appended, see appendStage).
+ * If track_changes is TRUE, the stages track the words that change after each clearChanges() call.
+ */
+ScalableBloomFilter::ScalableBloomFilter(unsigned long n, unsigned int k, unsigned long max_stage_bytes, bool track_changes):
+numStages(0), maxStageBytes(max_stage_bytes), trackChanges(track_changes)
+{
+    BloomFilter *first_stage = new BloomFilter(n, track_changes, k);
+    // The false positive rate of the first stage when half of its bits are set
+    startStage(first_stage, pow(0.5, first_stage->numHashes));
+}
+
+/**
+ * Create a Scalable Bloom Filter with the given Bloom Filter as its first stage.
+ * No stages are added on insertion (they can only be appended, see appendStage).
+ */
+ScalableBloomFilter::ScalableBloomFilter(BloomFilter *first_stage):
+numStages(0), maxStageBytes(0), trackChanges(false)
+{
+    startStage(first_stage, pow(0.5, first_stage->numHashes));
+}
+
+ScalableBloomFilter::~ScalableBloomFilter()
+{
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        delete this->stages[i];
+    }
+}
+
+/**
+ * Adds the given Bloom Filter at the end of the chain, with the specified false positive target,
+ * and calculates the number of items it can take before reaching this target.
+ */
+void ScalableBloomFilter::startStage(BloomFilter *stage, double target)
+{
+    this->stages[this->numStages++] = stage;
+    this->lastStageItems = 0;
+    this->lastStageTarget = target;
+    // The fill ratio where the false positive rate reaches the target, and the items needed to reach it
+    double max_fill = pow(target, 1.0 / stage->numHashes);
+    this->lastStageCapacity = (unsigned long)(-((double)stage->numBytes * 8 / stage->numHashes) * log(1 - max_fill));
+}
+
+/**
+ * Returns the number of stages (Bloom Filters) in the chain.
+ */
+unsigned int ScalableBloomFilter::getNumStages() const
+{
+    return this->numStages;
+}
+
+/**
+ * Returns the i-th stage of the chain.
+ */
+BloomFilter* ScalableBloomFilter::getStage(unsigned int i) const
+{
+    return this->stages[i];
+}
+
+/**
+ * Appends the given Bloom Filter (e.g. a received stage) at the end of the chain, which is now responsible for deleting it.
+ * If the chain already has BLOOM_MAX_STAGES stages, the Bloom Filter is deleted instead.
+ */
+void ScalableBloomFilter::appendStage(BloomFilter *stage)
+{
+    if (this->numStages == BLOOM_MAX_STAGES)
+    {
+        delete stage;
+        return;
+    }
+    startStage(stage, this->lastStageTarget * BLOOM_TIGHTENING_RATIO);
+}
+
+/**
+ * Returns TRUE if the specified data is "possibly present" in any stage of the chain, FALSE otherwise.
+ */
+bool ScalableBloomFilter::isPresent(void *data) const
+{
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        if (this->stages[i]->isPresent(data)) { return true; }
+    }
+    return false;
+}
+
+/**
+ * Marks the specified data as "present" in the last stage of the chain.
+ * If the last stage has reached its capacity, a new stage is added first (if allowed).
+ * Each item must only be marked once, since every call is counted as a new item.
+ */
+void ScalableBloomFilter::markAsPresent(void *data)
+{
+    if (this->lastStageItems >= this->lastStageCapacity && this->maxStageBytes > 0 && this->numStages < BLOOM_MAX_STAGES)
+    {
+        BloomFilter *last = this->stages[this->numStages - 1];
+        unsigned long n = last->numBytes * BLOOM_GROWTH_FACTOR;
+        if (n > this->maxStageBytes)
+        {
+            n = last->numBytes;
+        }
+        unsigned int k = (last->numHashes < K_MAX) ? last->numHashes + 1 : K_MAX;
+        startStage(new BloomFilter(n, this->trackChanges, k), this->lastStageTarget * BLOOM_TIGHTENING_RATIO);
+    }
+    this->stages[this->numStages - 1]->markAsPresent(data);
+    this->lastStageItems++;
+}
+
+/**
+ * Counts the specified number of items as inserted in the last stage, without marking them
+ * (e.g. items of other filters that are merged with this one), so that new stages are added earlier.
+ */
+void ScalableBloomFilter::countItems(unsigned long items)
+{
+    this->lastStageItems += items;
+}
+
+/**
+ * Merges the stages of the given chain in the stages of this one, using bitwise-OR.
+ * Stages that this chain does not have are copied at the end of the chain.
+ *
+ * @returns TRUE if the chains were merged, FALSE if any stage of the given chain cannot be
+ * folded in the respective stage of this one (see BloomFilter::canFold), in which case nothing is merged.
+ */
+bool ScalableBloomFilter::merge(const ScalableBloomFilter &other)
+{
+    for (unsigned int i = 0; i < other.numStages && i < this->numStages; i++)
+    {
+        if (!this->stages[i]->canFold(other.stages[i]->numBytes, other.stages[i]->numHashes))
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < other.numStages; i++)
+    {
+        const BloomFilter *stage = other.stages[i];
+        if (i >= this->numStages)
+        {
+            appendStage(new BloomFilter(stage->numBytes, this->trackChanges, stage->numHashes));
+        }
+        this->stages[i]->mergeFolded(stage->bits, 0, stage->numBytes);
+    }
+    return true;
+}
+
+/**
+ * Returns the total size (in bytes) of the stages.
+ */
+unsigned long ScalableBloomFilter::getNumBytes() const
+{
+    unsigned long total = 0;
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        total += this->stages[i]->numBytes;
+    }
+    return total;
+}
+
+/**
+ * Returns the total number of words of the stages that have changed since the last clearChanges() call.
+ */
+unsigned long ScalableBloomFilter::getNumChangedWords() const
+{
+    unsigned long total = 0;
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        total += this->stages[i]->getNumChangedWords();
+    }
+    return total;
+}
+
+/**
+ * Marks all the words of all the stages as unchanged.
+ */
+void ScalableBloomFilter::clearChanges()
+{
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        this->stages[i]->clearChanges();
+    }
+}
+
+/**
+ * Returns an estimation of the number of distinct items marked as present in all the stages
+ * (see BloomFilter::estimatedItems).
+ */
+double ScalableBloomFilter::estimatedItems() const
+{
+    double total = 0;
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        total += this->stages[i]->estimatedItems();
+    }
+    return total;
+}
+
+/**
+ * Returns the probability that an item that has not been marked as present is found "maybe present"
+ * in any of the stages, based on the number of set bits of each stage.
+ */
+double ScalableBloomFilter::estimatedFalsePositiveRate() const
+{
+    double all_negative = 1;
+    for (unsigned int i = 0; i < this->numStages; i++)
+    {
+        all_negative *= 1 - this->stages[i]->estimatedFalsePositiveRate();
+    }
+    return 1 - all_negative;
+}
@@ -13,10 +13,11 @@
  * @brief Creates a Skip List with the given parameters.
  * @param layers The maximum number of levels for the Skip List.
  * @param dest The function to be used for destroying elements when the Skip List is being destroyed.
+ * @param seed The seed of the generator used for selecting the level of new nodes.
  */
-SkipList::SkipList(int layers, DestroyFunc dest):
+SkipList::SkipList(int layers, DestroyFunc dest, unsigned long long seed):
 max_layer(( (layers < SKIP_LIST_MAX_LAYERS) ? layers : SKIP_LIST_MAX_LAYERS )), curr_layer(0), 
-layer_heads(new SkipListNode* [max_layer]), destroyElement(dest)
+layer_heads(new SkipListNode* [max_layer]), destroyElement(dest), random_state(seed)
 {
     for ( int i = 0; i < max_layer; i++ )
     {
@@ -316,16 +317,26 @@ void SkipList::remove(void *element, void **present, CompareFunc compare)
  * Returns a random layer number. The number can be between 0 and current level + 1,
  * but never above the maximum layer allowed.
  */
-int SkipList::getRandomLayer(void) const
+int SkipList::getRandomLayer(void)
 {
-    //int limit = ( ( (curr_layer + 1) < max_layer) ? (curr_layer + 1) : max_layer);
     int limit = ( ( (curr_layer + 1) < max_layer - 1) ? (curr_layer + 1) : max_layer - 1);
-    //for ( int i = 0; i < limit; i++ )
-    for ( int i = 0; i <= limit; i++ )
-    {
-        if ( rand() % 2 == 1 ) { return i; }
-    }
-    return limit - 1;
+    // Every bit of the drawn number is a fair coin flip, so the number of trailing zero bits
+    // is i with probability 1/2^(i+1), exactly like flipping a coin until it lands on heads.
+    unsigned long long bits = nextRandom();
+    int layer = (bits == 0) ? 64 : __builtin_ctzll(bits);
+    return (layer < limit) ? layer : limit;
+}
+
+/**
+ * Returns the next number of the pseudo-random generator of the Skip List (splitmix64).
+ * Each Skip List has its own generator state, so no global state (like rand()) is shared between lists.
+ */
+unsigned long long SkipList::nextRandom(void)
+{
+    unsigned long long x = (random_state += 0x9E3779B97F4A7C15ULL);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
 }
 
 /**
@@ -343,3 +354,53 @@ void SkipList::displayElements(DisplayFunc print) const
         current = current->next_nodes[0];
     }    
 }
+
+/**
+ * Returns an iterator to the first (smallest) element of the Skip List.
+ */
+SkipList::SkipListIterator SkipList::listHead() const
+{
+    return SkipListIterator(layer_heads[0]);
+}
+
+/**
+ * Skip List Iterator methods ---------------------------------------------------------------------
+ */
+
+/**
+ * Creates an iterator to the specified node.
+ */
+SkipList::SkipListIterator::SkipListIterator(SkipListNode *list_node):
+node(list_node) { }
+
+/**
+ * Returns the data of the node pointed by the iterator.
+ */
+void* SkipList::SkipListIterator::getData() const
+{
+    if (this->node == NULL)
+    {
+        return NULL;
+    }
+    return this->node->data;
+}
+
+/**
+ * Make the iterator point to the next node (in the lowest level).
+ * If the iterator does not point to a node, do nothing.
+ */
+void SkipList::SkipListIterator::forward()
+{
+    if (this->node != NULL)
+    {
+        this->node = this->node->next_nodes[0];
+    }
+}
+
+/**
+ * Returns TRUE if the iterator points to null, FALSE otherwise.
+ */
+bool SkipList::SkipListIterator::isNull() const
+{
+    return (this->node == NULL);
+}
@@ -0,0 +1,126 @@
+/**
+ * File: stats.cpp
+ * Counter & Latency Histogram class implementations.
+ * Pavlos Spanoudakis (sdi1800184)
+ */
+
+#include <ctime>
+
+#include "../include/stats.hpp"
+
+Counter::Counter(): value(0) { }
+
+/**
+ * Atomically adds n to the counter.
+ */
+void Counter::add(unsigned long long n)
+{
+    __sync_fetch_and_add(&value, n);
+}
+
+unsigned long long Counter::get() const
+{
+    return __atomic_load_n(&value, __ATOMIC_RELAXED);
+}
+
+LatencyHistogram::LatencyHistogram(): total_micros(0)
+{
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        buckets[i] = 0;
+    }
+}
+
+/**
+ * Atomically adds the specified latency (in microseconds) to the histogram.
+ */
+void LatencyHistogram::add(unsigned long long micros)
+{
+    // The bucket is the number of significant bits of the latency
+    unsigned int bucket = (micros == 0) ? 0 : (64 - __builtin_clzll(micros));
+    if (bucket >= LATENCY_BUCKETS)
+    {
+        bucket = LATENCY_BUCKETS - 1;
+    }
+    __sync_fetch_and_add(&buckets[bucket], 1);
+    __sync_fetch_and_add(&total_micros, micros);
+}
+
+/**
+ * Atomically adds count latencies in the specified bucket (used for merging histograms).
+ * The sum of the latencies must be added separately, using addTotal.
+ */
+void LatencyHistogram::addBucket(unsigned int bucket, unsigned long long count)
+{
+    if (bucket < LATENCY_BUCKETS)
+    {
+        __sync_fetch_and_add(&buckets[bucket], count);
+    }
+}
+
+/**
+ * Atomically adds the specified microseconds to the sum of the latencies (used for merging histograms).
+ */
+void LatencyHistogram::addTotal(unsigned long long micros)
+{
+    __sync_fetch_and_add(&total_micros, micros);
+}
+
+unsigned long long LatencyHistogram::getBucket(unsigned int bucket) const
+{
+    return (bucket < LATENCY_BUCKETS) ? __atomic_load_n(&buckets[bucket], __ATOMIC_RELAXED) : 0;
+}
+
+/**
+ * Returns the number of latencies in the histogram.
+ */
+unsigned long long LatencyHistogram::getCount() const
+{
+    unsigned long long count = 0;
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        count += getBucket(i);
+    }
+    return count;
+}
+
+unsigned long long LatencyHistogram::getTotalMicros() const
+{
+    return __atomic_load_n(&total_micros, __ATOMIC_RELAXED);
+}
+
+/**
+ * Returns an upper bound (in microseconds, exclusive) for the specified percentile (in [0, 100]) of the latencies,
+ * i.e. the upper bound of the bucket that contains it (0 if the histogram is empty).
+ */
+unsigned long long LatencyHistogram::percentileBound(double percentile) const
+{
+    unsigned long long count = getCount();
+    if (count == 0) { return 0; }
+    // The rank (1-based) of the requested latency
+    unsigned long long rank = (unsigned long long)(percentile * count / 100);
+    if (rank < percentile * count / 100 || rank == 0)
+    {
+        rank++;
+    }
+    unsigned long long seen = 0;
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += getBucket(i);
+        if (seen >= rank)
+        {
+            return 1ULL << i;
+        }
+    }
+    return 1ULL << (LATENCY_BUCKETS - 1);
+}
+
+/**
+ * Returns the current time of the monotonic clock, in microseconds.
+ */
+unsigned long long currentMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}